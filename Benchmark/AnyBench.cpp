@@ -0,0 +1,160 @@
+// AnyBench.cpp : a vector of mixed values (int, double, a short std::string, 32 and 48 byte arrays)
+// in std::any, SmallAny<32> and SmallAny<64>: allocations and ns per value to build and copy them,
+// ns per cast to the type a value holds and to one it does not hold, best of a few rounds. Global
+// operator new is replaced to count the allocations, the run fails if SmallAny<64> allocates for any
+// of these values.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp AnyBench.cpp -o AnyBench
+//   AnyBench [values, default 1000000]
+//
+// libstdc++'s std::any keeps one pointer's worth inline and checks the type by comparing its manager
+// function, falling back to type_info; SmallAny compares the address of its table only.
+// A SmallAny is as large as its buffer whatever it holds, a large set of them streams more memory than
+// std::any's 16 bytes do; the heap blocks std::any points to cost it a cache miss of its own.
+
+#include "Any.h"
+
+#include <any>
+#include <new>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	std::size_t allocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+	volatile double sink;
+
+	const int rounds = 3;
+
+	using Array32 = std::array<double, 4>;
+	using Array48 = std::array<double, 6>;
+
+	bool failed = false;
+
+	// std::any_cast and AnyCast side by side
+	template <typename T>
+	const T* Cast(const std::any& a) { return std::any_cast<T>(&a); }
+	template <typename T, std::size_t Size>
+	const T* Cast(const SmallAny<Size>& a) { return AnyCast<T>(&a); }
+
+	template <typename Any>
+	Any Make(std::size_t i)
+	{
+		switch (i % 5)
+		{
+		case 0: return Any(static_cast<int>(i));
+		case 1: return Any(static_cast<double>(i));
+		case 2: return Any(std::string("value ") + char('a' + i % 26));
+		case 3: return Any(Array32{ double(i) });
+		default: return Any(Array48{ double(i) });
+		}
+	}
+
+	template <typename Any>
+	double Sum(const std::vector<Any>& v)
+	{
+		double sum = 0;
+		for (std::size_t i = 0; i < v.size(); ++i)
+		{
+			switch (i % 5)
+			{
+			case 0: sum += *Cast<int>(v[i]); break;
+			case 1: sum += *Cast<double>(v[i]); break;
+			case 2: sum += Cast<std::string>(v[i])->size(); break;
+			case 3: sum += (*Cast<Array32>(v[i]))[0]; break;
+			default: sum += (*Cast<Array48>(v[i]))[0]; break;
+			}
+		}
+		return sum;
+	}
+
+	// every value asked for a type it is not, std::any compares type_info then
+	template <typename Any>
+	double Misses(const std::vector<Any>& v)
+	{
+		double misses = 0;
+		for (const Any& a : v)
+			misses += Cast<float>(a) == nullptr;
+		return misses;
+	}
+
+	template <typename Any>
+	void Run(const char* name, std::size_t count, bool mustNotAllocate)
+	{
+		// reused storage, the first round pays for the page faults and is not the best one
+		std::vector<Any> values, copy;
+		values.reserve(count);
+		copy.reserve(count);
+
+		double buildNs = 1e300, copyNs = 1e300, castNs = 1e300, missNs = 1e300;
+		double buildAllocs = 0, copyAllocs = 0;
+		auto best = [count](double& ns, bench_clock::time_point start) {
+			const std::chrono::duration<double, std::nano> took = bench_clock::now() - start;
+			ns = (std::min)(ns, took.count() / count);
+		};
+		for (int r = 0; r < rounds; ++r)
+		{
+			values.clear();
+			std::size_t before = allocations;
+			auto start = bench_clock::now();
+			for (std::size_t i = 0; i < count; ++i)
+				values.push_back(Make<Any>(i));
+			best(buildNs, start);
+			buildAllocs = double(allocations - before) / count;
+
+			copy.clear();
+			before = allocations;
+			start = bench_clock::now();
+			copy.assign(values.begin(), values.end());
+			best(copyNs, start);
+			copyAllocs = double(allocations - before) / count;
+
+			start = bench_clock::now();
+			sink = Sum(copy);
+			best(castNs, start);
+
+			start = bench_clock::now();
+			sink = Misses(copy);
+			best(missNs, start);
+		}
+
+		const bool bad = mustNotAllocate && (buildAllocs > 0 || copyAllocs > 0);
+		failed |= bad;
+		std::printf("%-14s %4zu bytes  build %6.1f ns %5.2f allocs  copy %6.1f ns %5.2f allocs  cast %5.2f ns  miss %5.2f ns%s\n",
+			name, sizeof(Any), buildNs, buildAllocs, copyNs, copyAllocs, castNs, missNs, bad ? "   FAIL" : "");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+	std::printf("%zu values, per value:\n", count);
+
+	Run<std::any>("std::any", count, false);
+	Run<SmallAny<32>>("SmallAny<32>", count, false);
+	Run<SmallAny<64>>("SmallAny<64>", count, true);
+
+	return failed ? 1 : 0;
+}
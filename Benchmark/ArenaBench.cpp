@@ -0,0 +1,108 @@
+// ArenaBench.cpp : one request's worth of Cpp11 objects, built in a std::pmr::vector, grown past their
+// inline values and dropped together, on the default heap, an Arena and a PooledArena. Global operator
+// new is replaced to count the allocations that reach the heap, the run fails if an arena passes on
+// more than one per hundred objects.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp ArenaBench.cpp <moderncpp library> -o ArenaBench
+
+#include "Arena.h"
+#include "Cpp11.h"
+
+#include <new>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <memory_resource>
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	std::size_t allocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// std::pmr's default resource asks for an alignment, count those too
+void* operator new(std::size_t size, std::align_val_t align)
+{
+	++allocations;
+	const std::size_t a = (std::max)(static_cast<std::size_t>(align), sizeof(void*));
+	if (void* raw = std::malloc(size + a))
+	{
+		void* p = reinterpret_cast<void*>((reinterpret_cast<std::uintptr_t>(raw) + a) & ~(a - 1));
+		static_cast<void**>(p)[-1] = raw;
+		return p;
+	}
+	throw std::bad_alloc();
+}
+void operator delete(void* p, std::align_val_t) noexcept { if (p) std::free(static_cast<void**>(p)[-1]); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { if (p) std::free(static_cast<void**>(p)[-1]); }
+
+namespace
+{
+	volatile long sink;
+
+	const int objects = 1000;
+	const int requests = 200;
+
+	bool failed = false;
+
+	struct Heap {
+		std::pmr::memory_resource* resource() { return std::pmr::get_default_resource(); }
+	};
+
+	// a request: objects built, each given more values than fit inline, then all dropped at once
+	void Request(std::pmr::memory_resource* resource)
+	{
+		std::pmr::vector<Cpp11> batch(resource);
+		for (int i = 0; i < objects; ++i)
+		{
+			batch.emplace_back(i, i);
+			batch.back() = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 };
+		}
+		sink = batch.back().getLength();
+	}
+
+	// ns and heap allocations per object, a fresh resource per request
+	template <typename Resource>
+	void Run(const char* name, double maxAllocations)
+	{
+		const std::size_t before = allocations;
+		const auto start = bench_clock::now();
+		for (int r = 0; r < requests; ++r)
+		{
+			Resource resource;
+			Request(resource.resource());
+		}
+		const std::chrono::duration<double, std::nano> took = bench_clock::now() - start;
+		const double perObject = double(allocations - before) / (double(requests) * objects);
+
+		const bool bad = perObject > maxAllocations;
+		failed |= bad;
+		std::printf("%-32s %8.1f ns %10.3f allocs%s\n", name, took.count() / (double(requests) * objects), perObject, bad ? "   FAIL" : "");
+	}
+}
+
+int main()
+{
+	std::printf("%d requests of %d Cpp11 objects, per object\n", requests, objects);
+
+	Run<Heap>("default heap", 1e9);
+	Run<Arena<64 * 1024>>("Arena<64K>", 0.01);
+	Run<PooledArena<64 * 1024>>("PooledArena<64K>", 0.01);
+
+	return failed ? 1 : 0;
+}
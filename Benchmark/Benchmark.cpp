@@ -0,0 +1,304 @@
+// Benchmark.cpp : runs every registered case and reports min/median/p99/max and ops/sec.
+//
+//   ModernCppBench [--warmup N] [--iterations N] [--filter TEXT] [--json [FILE]] [--verbose] [--list]
+//
+// By default the demo output is suppressed while timing (std::cout goes to a null buffer and
+// file descriptor 1 to the null device), so the numbers measure the code and not the terminal.
+
+#include "Benchmark.h"
+#include "Log.h"
+
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <streambuf>
+
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fileno _fileno
+#define close _close
+static const char* const null_device = "NUL";
+#else
+#include <unistd.h>
+static const char* const null_device = "/dev/null";
+#endif
+
+namespace MODERNCPP::BENCH
+{
+	Registry& Registry::Instance()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	namespace
+	{
+		struct Options {
+			std::size_t warmup = 3;
+			std::size_t iterations = 50;
+			std::string filter;
+			bool quiet = true;
+			bool json = false;
+			std::string jsonPath;			// empty = stdout
+			bool list = false;
+		};
+
+		// swallows everything written to it
+		class NullBuffer : public std::streambuf {
+		protected:
+			int overflow(int c) override { return traits_type::not_eof(c); }
+			std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+		};
+
+		// RAII, silences std::cout, stdout (printf, puts) and the log sink for its lifetime
+		class StdoutSilencer {
+		public:
+			explicit StdoutSilencer(bool enabled) : m_enabled(enabled)
+			{
+				if (!m_enabled)
+					return;
+				// records logged before the run still belong on the console
+				MODERNCPP::LogSink::Instance().Flush();
+				std::cout.flush();
+				std::fflush(stdout);
+				m_saved = std::cout.rdbuf(&m_null);
+				m_savedFd = dup(fileno(stdout));
+				if (std::FILE* devnull = std::fopen(null_device, "w"))
+				{
+					dup2(fileno(devnull), fileno(stdout));
+					std::fclose(devnull);
+				}
+			}
+
+			~StdoutSilencer()
+			{
+				if (!m_enabled)
+					return;
+				// and what the benchmark logged must hit /dev/null, not the report
+				MODERNCPP::LogSink::Instance().Flush();
+				std::fflush(stdout);
+				if (m_savedFd >= 0)
+				{
+					dup2(m_savedFd, fileno(stdout));
+					close(m_savedFd);
+				}
+				std::cout.rdbuf(m_saved);
+			}
+
+			StdoutSilencer(const StdoutSilencer&) = delete;
+			StdoutSilencer& operator=(const StdoutSilencer&) = delete;
+
+		private:
+			bool m_enabled;
+			NullBuffer m_null;
+			std::streambuf* m_saved = nullptr;
+			int m_savedFd = -1;
+		};
+
+		Stats Measure(const Case& c, const Options& opt)
+		{
+			using clock = std::chrono::steady_clock;
+
+			std::size_t warmup = opt.warmup;
+			std::size_t iterations = opt.iterations;
+			if (c.maxIterations != 0)
+			{
+				warmup = 0;
+				iterations = (std::min)(iterations, c.maxIterations);
+			}
+			iterations = (std::max)(iterations, std::size_t(1));
+
+			std::vector<double> samples;
+			samples.reserve(iterations);
+			{
+				StdoutSilencer silence(opt.quiet);
+				for (std::size_t i = 0; i < warmup; ++i)
+					c.run();
+				for (std::size_t i = 0; i < iterations; ++i)
+				{
+					const auto t0 = clock::now();
+					c.run();
+					const auto t1 = clock::now();
+					samples.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+				}
+			}
+
+			Stats s;
+			s.iterations = samples.size();
+			double total = 0;
+			for (double v : samples)
+				total += v;
+			std::sort(samples.begin(), samples.end());
+			s.min_ns = samples.front();
+			s.max_ns = samples.back();
+			s.median_ns = samples.size() % 2 ? samples[samples.size() / 2]
+				: (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+			// nearest-rank percentile
+			const std::size_t rank = static_cast<std::size_t>(std::ceil(0.99 * samples.size()));
+			s.p99_ns = samples[(std::max)(rank, std::size_t(1)) - 1];
+			s.mean_ns = total / samples.size();
+			s.ops_per_sec = total > 0 ? 1e9 * samples.size() / total : 0;
+			return s;
+		}
+
+		std::string Human(double ns)
+		{
+			std::ostringstream out;
+			out << std::fixed << std::setprecision(2);
+			if (ns < 1e3)
+				out << ns << " ns";
+			else if (ns < 1e6)
+				out << ns / 1e3 << " us";
+			else if (ns < 1e9)
+				out << ns / 1e6 << " ms";
+			else
+				out << ns / 1e9 << " s";
+			return out.str();
+		}
+
+		void PrintTable(std::ostream& out, const std::vector<std::pair<const Case*, Stats>>& results)
+		{
+			std::size_t width = 9;
+			for (const auto& r : results)
+				width = (std::max)(width, r.first->FullName().size());
+
+			out << std::left << std::setw(static_cast<int>(width)) << "benchmark" << std::right
+				<< std::setw(7) << "iters"
+				<< std::setw(13) << "min"
+				<< std::setw(13) << "median"
+				<< std::setw(13) << "p99"
+				<< std::setw(13) << "max"
+				<< std::setw(15) << "ops/sec" << '\n';
+			out << std::string(width + 74, '-') << '\n';
+
+			for (const auto& r : results)
+			{
+				const Stats& s = r.second;
+				out << std::left << std::setw(static_cast<int>(width)) << r.first->FullName() << std::right
+					<< std::setw(7) << s.iterations
+					<< std::setw(13) << Human(s.min_ns)
+					<< std::setw(13) << Human(s.median_ns)
+					<< std::setw(13) << Human(s.p99_ns)
+					<< std::setw(13) << Human(s.max_ns)
+					<< std::setw(15) << std::fixed << std::setprecision(1) << s.ops_per_sec << '\n';
+			}
+			out.flush();
+		}
+
+		std::string JsonEscape(const std::string& text)
+		{
+			std::string out;
+			for (char ch : text)
+			{
+				if (ch == '"' || ch == '\\')
+					out += '\\';
+				out += ch;
+			}
+			return out;
+		}
+
+		void PrintJson(std::ostream& out, const std::vector<std::pair<const Case*, Stats>>& results, const Options& opt)
+		{
+			out << std::setprecision(10);
+			out << "{\n  \"warmup\": " << opt.warmup << ",\n  \"iterations\": " << opt.iterations
+				<< ",\n  \"benchmarks\": [\n";
+			for (std::size_t i = 0; i < results.size(); ++i)
+			{
+				const Case& c = *results[i].first;
+				const Stats& s = results[i].second;
+				out << "    {\"group\": \"" << JsonEscape(c.group) << "\", \"name\": \"" << JsonEscape(c.name)
+					<< "\", \"iterations\": " << s.iterations
+					<< ", \"min_ns\": " << s.min_ns
+					<< ", \"median_ns\": " << s.median_ns
+					<< ", \"p99_ns\": " << s.p99_ns
+					<< ", \"max_ns\": " << s.max_ns
+					<< ", \"mean_ns\": " << s.mean_ns
+					<< ", \"ops_per_sec\": " << s.ops_per_sec << "}"
+					<< (i + 1 < results.size() ? ",\n" : "\n");
+			}
+			out << "  ]\n}\n";
+			out.flush();
+		}
+
+		bool ParseArgs(int argc, char** argv, Options& opt)
+		{
+			for (int i = 1; i < argc; ++i)
+			{
+				const std::string arg = argv[i];
+				const bool hasValue = i + 1 < argc;
+
+				if (arg == "--warmup" && hasValue)
+					opt.warmup = std::strtoul(argv[++i], nullptr, 10);
+				else if (arg == "--iterations" && hasValue)
+					opt.iterations = std::strtoul(argv[++i], nullptr, 10);
+				else if (arg == "--filter" && hasValue)
+					opt.filter = argv[++i];
+				else if (arg == "--json")
+				{
+					opt.json = true;
+					if (hasValue && argv[i + 1][0] != '-')
+						opt.jsonPath = argv[++i];
+				}
+				else if (arg == "--verbose")
+					opt.quiet = false;
+				else if (arg == "--list")
+					opt.list = true;
+				else
+				{
+					std::cerr << "usage: " << argv[0]
+						<< " [--warmup N] [--iterations N] [--filter TEXT] [--json [FILE]] [--verbose] [--list]\n";
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace MODERNCPP::BENCH;
+
+	Options opt;
+	if (!ParseArgs(argc, argv, opt))
+		return 2;
+
+	std::vector<std::pair<const Case*, Stats>> results;
+	for (const Case& c : Registry::Instance().Cases())
+	{
+		if (!opt.filter.empty() && c.FullName().find(opt.filter) == std::string::npos)
+			continue;
+		if (opt.list)
+		{
+			std::cout << c.FullName() << '\n';
+			continue;
+		}
+		std::cerr << "running " << c.FullName() << "...\n";
+		results.emplace_back(&c, Measure(c, opt));
+	}
+	if (opt.list)
+		return 0;
+
+	// with --json to stdout the table moves to stderr, so stdout stays machine readable
+	PrintTable(opt.json && opt.jsonPath.empty() ? std::cerr : std::cout, results);
+	if (opt.json)
+	{
+		if (opt.jsonPath.empty())
+			PrintJson(std::cout, results, opt);
+		else
+		{
+			std::ofstream file(opt.jsonPath);
+			PrintJson(file, results, opt);
+		}
+	}
+	return 0;
+}
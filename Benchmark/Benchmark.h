@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef __MODERN_CPP_BENCHMARK_H
+#define __MODERN_CPP_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <functional>
+
+// Minimal benchmark harness: every case is a void() callable registered at static
+// initialization time, timed over warm-up + measured iterations by Benchmark.cpp's main().
+
+namespace MODERNCPP::BENCH
+{
+	struct Case {
+		std::string group;					// e.g. "Cpp11"
+		std::string name;					// e.g. "RegularExpression"
+		std::function<void()> run;
+		std::size_t maxIterations = 0;		// 0 = as many as asked for, otherwise no warm-up and at most this many
+
+		std::string FullName() const { return group + "/" + name; }
+	};
+
+	struct Stats {
+		std::size_t iterations = 0;
+		double min_ns = 0, median_ns = 0, p99_ns = 0, max_ns = 0, mean_ns = 0;
+		double ops_per_sec = 0;
+	};
+
+	class Registry {
+	public:
+		static Registry& Instance();
+
+		void Add(Case c) { m_cases.push_back(std::move(c)); }
+		const std::vector<Case>& Cases() const { return m_cases; }
+
+	private:
+		std::vector<Case> m_cases;
+	};
+
+	struct Registrar {
+		Registrar(const char* group, const char* name, std::function<void()> run, std::size_t maxIterations = 0)
+		{
+			Registry::Instance().Add({ group, name, std::move(run), maxIterations });
+		}
+	};
+
+	// keep a computed value alive without printing it
+	template <typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+}
+
+#define MODERNCPP_BENCH_CAT2(a, b) a##b
+#define MODERNCPP_BENCH_CAT(a, b) MODERNCPP_BENCH_CAT2(a, b)
+
+// MODERNCPP_BENCHMARK("Cpp11", "Lambda", [] { cpp11.Lambda(); });
+// MODERNCPP_BENCHMARK("Cpp11", "DoWork", [] { ... }, 2);		// slow case, at most 2 iterations
+#define MODERNCPP_BENCHMARK(group, name, ...) \
+	static ::MODERNCPP::BENCH::Registrar MODERNCPP_BENCH_CAT(s_bench_, __LINE__)(group, name, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,75 @@
+// ConcatBench.cpp : four strings put together the way VariadicTemplate() used to (adder), with
+// operator+, and with Concat / Join. Global operator new is replaced to count allocations, the run
+// fails if Concat or Join allocates more than once per call.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp ConcatBench.cpp -o ConcatBench
+//
+// The strings are longer than the small string buffer, so every temporary allocates.
+
+#include "Concat.h"
+#include "Cpp11.h"
+
+#include <new>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	std::size_t allocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+	volatile std::size_t sink;
+
+	const int calls = 1000000;
+
+	bool failed = false;
+
+	// ns and allocations per call
+	template <typename F>
+	void Run(const char* name, double maxAllocations, F&& build)
+	{
+		std::size_t size = 0;
+		const std::size_t before = allocations;
+		const auto start = bench_clock::now();
+		for (int i = 0; i < calls; ++i)
+			size += build(i).size();
+		const std::chrono::duration<double, std::nano> took = bench_clock::now() - start;
+		const double perCall = double(allocations - before) / calls;
+		sink = size;
+
+		const bool bad = perCall > maxAllocations;
+		failed |= bad;
+		std::printf("%-40s %8.1f ns %8.2f allocs%s\n", name, took.count() / calls, perCall, bad ? "   FAIL" : "");
+	}
+}
+
+int main()
+{
+	const std::string s1 = "the first of four strings", s2 = "the second of four strings",
+		s3 = "the third of four strings", s4 = "the fourth of four strings";
+
+	Run("adder(s1, s2, s3, s4)", 1e9, [&](int) { return adder(s1, s2, s3, s4); });
+	Run("s1 + s2 + s3 + s4", 1e9, [&](int) { return s1 + s2 + s3 + s4; });
+	Run("Concat(s1, s2, s3, s4)", 1, [&](int) { return Concat(s1, s2, s3, s4); });
+	Run("Concat(\"call \", i, ' ', s1, \" of \", s2)", 1, [&](int i) { return Concat("call ", i, ' ', s1, " of ", s2); });
+	Run("Join(\", \", s1, s2, s3, s4)", 1, [&](int) { return Join(", ", s1, s2, s3, s4); });
+
+	return failed ? 1 : 0;
+}
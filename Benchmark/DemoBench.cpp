@@ -0,0 +1,99 @@
+// DemoBench.cpp : every routine main() in ModernCpp.cpp calls, one benchmark case each.
+// This is the baseline the optimizations are measured against, keep it in sync with main().
+
+#include "Benchmark.h"
+
+#include "Cpp11.h"
+#include "Cpp14.h"
+#include "Cpp17.h"
+
+using namespace MODERNCPP;
+using namespace MODERNCPP::CPP17;
+using MODERNCPP::BENCH::DoNotOptimize;
+
+namespace
+{
+	// one object per standard, like main()
+	Cpp11 cpp11;
+	Cpp14 cpp14;
+	Cpp17 cpp17;
+
+	// these sleep for a second or two on purpose, a couple of iterations is plenty
+	const std::size_t sleepy = 2;
+}
+
+#pragma region Cpp11
+
+MODERNCPP_BENCHMARK("Cpp11", "ConstExpr", [] { DoNotOptimize(cpp11.ConstExpr(2, 3)); });
+MODERNCPP_BENCHMARK("Cpp11", "ForEachLoop", [] { cpp11.ForEachLoop(); });
+MODERNCPP_BENCHMARK("Cpp11", "EnumClass", [] { DoNotOptimize(cpp11.EnumClass(WeekDay::Friday)); });
+MODERNCPP_BENCHMARK("Cpp11", "Lambda", [] { cpp11.Lambda(); });
+MODERNCPP_BENCHMARK("Cpp11", "PseudoNumberGenerator", [] { DoNotOptimize(cpp11.PseudoNumberGenerator(1, 6)); });
+MODERNCPP_BENCHMARK("Cpp11", "RandomNumberGenerator", [] { DoNotOptimize(cpp11.RandomNumberGenerator(1, 6)); });
+MODERNCPP_BENCHMARK("Cpp11", "Tuple", [] { cpp11.Tuple(); });
+MODERNCPP_BENCHMARK("Cpp11", "UniquePtr", [] { cpp11.UniquePtr(); });
+MODERNCPP_BENCHMARK("Cpp11", "NullPtr", [] { cpp11.NullPtr(nullptr); });
+MODERNCPP_BENCHMARK("Cpp11", "ReferenceWrapper", [] { cpp11.ReferenceWrapper(); });
+MODERNCPP_BENCHMARK("Cpp11", "InitializerList", [] { cpp11.InitializerList(); });
+MODERNCPP_BENCHMARK("Cpp11", "StaticAssert", [] { cpp11.StaticAssert(); });
+MODERNCPP_BENCHMARK("Cpp11", "VariadicTemplate", [] { cpp11.VariadicTemplate(); });
+MODERNCPP_BENCHMARK("Cpp11", "UnorderedContainers", [] { cpp11.UnorderedContainers(); });
+MODERNCPP_BENCHMARK("Cpp11", "ParallelThreads", [] { cpp11.ParallelThreads(); });
+MODERNCPP_BENCHMARK("Cpp11", "ProducerConsumer", [] { cpp11.ProducerConsumer(); });
+MODERNCPP_BENCHMARK("Cpp11", "DetachedThread", [] { cpp11.DetachedThread(); }, sleepy);
+MODERNCPP_BENCHMARK("Cpp11", "RegularExpression", [] { cpp11.RegularExpression(); });
+MODERNCPP_BENCHMARK("Cpp11", "VariableSizes", [] { cpp11.VariableSizes(); });
+MODERNCPP_BENCHMARK("Cpp11", "TrailingReturnType", [] { DoNotOptimize(cpp11.TrailingReturnType()); });
+MODERNCPP_BENCHMARK("Cpp11", "DeclType", [] { cpp11.DeclType(); });
+MODERNCPP_BENCHMARK("Cpp11", "NoReturn", [] { IGNORE_EXCEPTION(cpp11.NoReturn); });
+MODERNCPP_BENCHMARK("Cpp11", "NoReturnExpected", [] { DoNotOptimize(cpp11.NoReturnExpected()); });
+MODERNCPP_BENCHMARK("Cpp11", "DoWork", [] { std::thread t1(Cpp11::DoWork, &cpp11); t1.join(); }, sleepy);
+MODERNCPP_BENCHMARK("Cpp11", "DoWorkAsync", [] { cpp11.DoWorkAsync(1).wait(); }, sleepy);
+
+#pragma endregion
+
+#pragma region Cpp14
+
+MODERNCPP_BENCHMARK("Cpp14", "AggregateMemberInitialization", [] { cpp14.AggregateMemberInitialization(); });
+MODERNCPP_BENCHMARK("Cpp14", "BinaryLiterals", [] { cpp14.BinaryLiterals(); });
+MODERNCPP_BENCHMARK("Cpp14", "DigitSeparators", [] { cpp14.DigitSeparators(); });
+MODERNCPP_BENCHMARK("Cpp14", "ReturnTypeDeduction", [] { DoNotOptimize(cpp14.ReturnTypeDeduction(1, 2)); });
+MODERNCPP_BENCHMARK("Cpp14", "GenericLambdaExpr", [] { cpp14.GenericLambdaExpr(); });
+MODERNCPP_BENCHMARK("Cpp14", "LambdaCaptureExpr", [] { cpp14.LambdaCaptureExpr(); });
+MODERNCPP_BENCHMARK("Cpp14", "ConstantExprRestriction", [] { cpp14.ConstantExprRestriction(); });
+MODERNCPP_BENCHMARK("Cpp14", "VariableTemplate", [] { cpp14.VariableTemplate(); });
+MODERNCPP_BENCHMARK("Cpp14", "TupleAddressingByType", [] { cpp14.TupleAddressingByType(); });
+MODERNCPP_BENCHMARK("Cpp14", "MakeUnique", [] { cpp14.MakeUnique(); });
+MODERNCPP_BENCHMARK("Cpp14", "DeprecatedMethod", [] { cpp14.DeprecatedMethod(); });
+MODERNCPP_BENCHMARK("Cpp14", "HeterogeneousLookupAssocContainers", [] { cpp14.HeterogeneousLookupAssocContainers(); });
+MODERNCPP_BENCHMARK("Cpp14", "SharedMutexesLocking", [] { cpp14.SharedMutexesLocking(); });
+
+#pragma endregion
+
+#pragma region Cpp17
+
+MODERNCPP_BENCHMARK("Cpp17", "Preprocessor", [] { DoNotOptimize(cpp17.Preprocessor(0)); });
+MODERNCPP_BENCHMARK("Cpp17", "StaticAssert", [] { cpp17.StaticAssert(); });
+MODERNCPP_BENCHMARK("Cpp17", "StdAny", [] { cpp17.StdAny(); });
+MODERNCPP_BENCHMARK("Cpp17", "StdByte", [] { cpp17.StdByte(); });
+MODERNCPP_BENCHMARK("Cpp17", "StdFileSystem", [] { cpp17.StdFileSystem(); });
+MODERNCPP_BENCHMARK("Cpp17", "StdOptional", [] { cpp17.StdOptional(); });
+MODERNCPP_BENCHMARK("Cpp17", "StdVariant", [] { cpp17.StdVariant(); });
+MODERNCPP_BENCHMARK("Cpp17", "StdConjunction", [] { cpp17.StdConjunction(); });
+MODERNCPP_BENCHMARK("Cpp17", "StdDisjunction", [] { cpp17.StdDisjunction(); });
+MODERNCPP_BENCHMARK("Cpp17", "StdNegation", [] { cpp17.StdNegation(); });
+MODERNCPP_BENCHMARK("Cpp17", "StdUncaughtExceptions", [] { cpp17.StdUncaughtExceptions(); });
+MODERNCPP_BENCHMARK("Cpp17", "StructuredBindingDeclaration", [] { cpp17.StructuredBindingDeclaration(); });
+MODERNCPP_BENCHMARK("Cpp17", "TemplateArgumentDeduction", [] { DoNotOptimize(cpp17.TemplateArgumentDeduction('a', 123, true)); });
+MODERNCPP_BENCHMARK("Cpp17", "TemplateDeductionConstructor", [] { cpp17.TemplateDeductionConstructor(); });
+MODERNCPP_BENCHMARK("Cpp17", "IfSwitchInitializer", [] { cpp17.IfSwitchInitializer(); });
+MODERNCPP_BENCHMARK("Cpp17", "CompileTimeIf", [] { DoNotOptimize(cpp17.CompileTimeIf(1)); });
+MODERNCPP_BENCHMARK("Cpp17", "InlineVariable", [] { cpp17.InlineVariable(); });
+MODERNCPP_BENCHMARK("Cpp17", "FoldExpression", [] { cpp17.FoldExpression(); });
+MODERNCPP_BENCHMARK("Cpp17", "RemovedTrigraphs", [] { cpp17.RemovedTrigraphs(); });
+MODERNCPP_BENCHMARK("Cpp17", "Utf8Literals", [] { cpp17.Utf8Literals(); });
+MODERNCPP_BENCHMARK("Cpp17", "HexFloatingPointLiterals", [] { cpp17.HexFloatingPointLiterals(); });
+MODERNCPP_BENCHMARK("Cpp17", "StandardAttributes", [] { DoNotOptimize(cpp17.StandardAttributes(true)); });
+MODERNCPP_BENCHMARK("Cpp17", "SpecialMathFunctions", [] { cpp17.SpecialMathFunctions(); });
+
+#pragma endregion
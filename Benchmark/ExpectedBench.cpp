@@ -0,0 +1,125 @@
+// ExpectedBench.cpp : a three frame deep call that fails at 0%, 1% and 50% of its inputs, reporting
+// the failure with a throw caught by the caller and with an Expected returned through every frame.
+// Times are ns per call, best of a few rounds.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp ExpectedBench.cpp -o ExpectedBench
+//   ExpectedBench [calls, default 1000000]
+//
+// The frames are kept out of line, as they would be in real code, so the throw has frames to unwind
+// and the Expected has returns to pass through. The run fails if both ways do not count the same
+// results and errors.
+
+#include "Expected.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	volatile long long sink;
+
+	const int rounds = 3;
+
+	// a negative input is bad
+	BENCH_NOINLINE int ParseThrow(int x)
+	{
+		if (x < 0)
+			throw std::invalid_argument("negative input");
+		return x * 2;
+	}
+	BENCH_NOINLINE int ScaleThrow(int x) { return ParseThrow(x) + 1; }
+	BENCH_NOINLINE int RunThrow(int x) { return ScaleThrow(x) * 3; }
+
+	BENCH_NOINLINE Expected<int, const char*> ParseExpected(int x)
+	{
+		if (x < 0)
+			return Unexpected("negative input");
+		return x * 2;
+	}
+	BENCH_NOINLINE Expected<int, const char*> ScaleExpected(int x) { return ParseExpected(x).transform([](int v) { return v + 1; }); }
+	BENCH_NOINLINE Expected<int, const char*> RunExpected(int x) { return ScaleExpected(x).transform([](int v) { return v * 3; }); }
+
+	struct Tally {
+		long long sum = 0;
+		std::size_t errors = 0;
+	};
+
+	template <typename F>
+	double NsPerCall(const std::vector<int>& inputs, Tally& tally, F&& pass)
+	{
+		double best = 1e300;
+		for (int r = 0; r < rounds; ++r)
+		{
+			const auto start = bench_clock::now();
+			tally = pass();
+			const std::chrono::duration<double, std::nano> took = bench_clock::now() - start;
+			best = (std::min)(best, took.count() / inputs.size());
+			sink = tally.sum;
+		}
+		return best;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t calls = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+	std::printf("%zu calls, 3 frames deep, ns per call\n", calls);
+	std::printf("%8s %14s %14s %10s\n", "errors", "throw", "Expected", "ratio");
+
+	bool failed = false;
+	for (const double rate : { 0.0, 0.01, 0.5 })
+	{
+		std::mt19937 random(42);
+		std::bernoulli_distribution fails(rate);
+		std::vector<int> inputs(calls);
+		for (int& x : inputs)
+			x = fails(random) ? -1 : static_cast<int>(random() % 1000);
+
+		Tally thrown, returned;
+		const double t = NsPerCall(inputs, thrown, [&] {
+			Tally tally;
+			for (const int x : inputs)
+			{
+				try
+				{
+					tally.sum += RunThrow(x);
+				}
+				catch (const std::invalid_argument&)
+				{
+					++tally.errors;
+				}
+			}
+			return tally;
+		});
+		const double e = NsPerCall(inputs, returned, [&] {
+			Tally tally;
+			for (const int x : inputs)
+			{
+				if (const auto r = RunExpected(x))
+					tally.sum += *r;
+				else
+					++tally.errors;
+			}
+			return tally;
+		});
+
+		const bool bad = thrown.sum != returned.sum || thrown.errors != returned.errors;
+		failed |= bad;
+		std::printf("%7.0f%% %11.2f ns %11.2f ns %9.1fx%s\n", rate * 100, t, e, t / e, bad ? "   FAIL" : "");
+	}
+	return failed ? 1 : 0;
+}
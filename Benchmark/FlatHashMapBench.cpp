@@ -0,0 +1,127 @@
+// FlatHashMapBench.cpp : FlatHashMap vs std::unordered_map, string keys like the Cpp11 color table,
+// 10^3 to 10^7 of them. Times are ns per operation, best of a few rounds.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp FlatHashMapBench.cpp -o FlatHashMapBench
+//   FlatHashMapBench [max power of ten, default 7]
+//
+// insert    : every key once into an empty map, no reserve
+// hit       : every key looked up by string_view (unordered_map needs a std::string built from it)
+// miss      : as many lookups of keys that are not there
+
+#include "FlatHashMap.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	volatile std::size_t sink;
+
+	// a prefix and 8 hex digits, scrambled, so neighbouring keys do not hash alike
+	std::vector<std::string> MakeKeys(std::size_t n, char prefix)
+	{
+		std::vector<std::string> keys;
+		keys.reserve(n);
+		char buf[16];
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			const std::uint32_t x = static_cast<std::uint32_t>(i * 2654435761u);
+			std::snprintf(buf, sizeof(buf), "%c%08X", prefix, x);
+			keys.emplace_back(buf);
+		}
+		return keys;
+	}
+
+	template <typename F>
+	double NsPerOp(std::size_t ops, int rounds, F&& pass)
+	{
+		double best = 1e300;
+		for (int r = 0; r < rounds; ++r)
+		{
+			const auto start = bench_clock::now();
+			pass();
+			const std::chrono::duration<double, std::nano> took = bench_clock::now() - start;
+			best = (std::min)(best, took.count() / double(ops));
+		}
+		return best;
+	}
+
+	struct Result {
+		double insert, hit, miss;
+	};
+
+	template <typename Map, typename Lookup>
+	Result Measure(const std::vector<std::string>& keys, const std::vector<std::string_view>& present,
+		const std::vector<std::string_view>& absent, int rounds, Lookup&& lookup)
+	{
+		Result r;
+		Map map;
+		r.insert = NsPerOp(keys.size(), rounds, [&] {
+			Map m;
+			for (std::size_t i = 0; i < keys.size(); ++i)
+				m[keys[i]] = static_cast<std::uint32_t>(i);
+			map = std::move(m);
+		});
+		r.hit = NsPerOp(present.size(), rounds, [&] {
+			std::size_t sum = 0;
+			for (std::string_view k : present)
+				sum += lookup(map, k);
+			sink = sum;
+		});
+		r.miss = NsPerOp(absent.size(), rounds, [&] {
+			std::size_t sum = 0;
+			for (std::string_view k : absent)
+				sum += lookup(map, k);
+			sink = sum;
+		});
+		return r;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const int maxPower = argc > 1 ? std::atoi(argv[1]) : 7;
+
+	std::printf("%10s  %28s  %28s  %28s\n", "", "insert ns", "hit ns", "miss ns");
+	std::printf("%10s  %8s %10s %8s  %8s %10s %8s  %8s %10s %8s\n", "keys",
+		"unord", "flat", "speedup", "unord", "flat", "speedup", "unord", "flat", "speedup");
+
+	for (int p = 3; p <= maxPower; ++p)
+	{
+		std::size_t n = 1;
+		for (int i = 0; i < p; ++i)
+			n *= 10;
+		const int rounds = p <= 5 ? 5 : p == 6 ? 3 : 1;
+
+		const std::vector<std::string> keys = MakeKeys(n, '#');
+		const std::vector<std::string> others = MakeKeys(n, '$');
+
+		// looked up in a different order than inserted
+		std::vector<std::string_view> present(keys.rbegin(), keys.rend());
+		const std::vector<std::string_view> absent(others.begin(), others.end());
+
+		const Result u = Measure<std::unordered_map<std::string, std::uint32_t>>(keys, present, absent, rounds,
+			[](const std::unordered_map<std::string, std::uint32_t>& m, std::string_view k) {
+				const auto i = m.find(std::string(k));
+				return i == m.end() ? 0 : std::size_t(i->second);
+			});
+		const Result f = Measure<FlatHashMap<std::string, std::uint32_t>>(keys, present, absent, rounds,
+			[](const FlatHashMap<std::string, std::uint32_t>& m, std::string_view k) {
+				const auto i = m.find(k);
+				return i == m.end() ? 0 : std::size_t(i->second);
+			});
+
+		std::printf("%10zu  %8.1f %10.1f %7.2fx  %8.1f %10.1f %7.2fx  %8.1f %10.1f %7.2fx\n", n,
+			u.insert, f.insert, u.insert / f.insert, u.hit, f.hit, u.hit / f.hit, u.miss, f.miss, u.miss / f.miss);
+	}
+	return 0;
+}
@@ -0,0 +1,32 @@
+// LogBench.cpp : the demos' old console pattern, a stream flushed by std::endl on every line,
+// against Log() records batched by the asynchronous sink. Both write to the null device: the
+// harness swaps std::cout's buffer out while timing, a file stream still pays for its writes.
+
+#include "Benchmark.h"
+#include "Log.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace MODERNCPP;
+
+namespace
+{
+	const int lines = 10000;
+
+#if defined(_WIN32)
+	std::ofstream null_stream("NUL");
+#else
+	std::ofstream null_stream("/dev/null");
+#endif
+}
+
+MODERNCPP_BENCHMARK("Log", "std::endl per line 10K lines", [] {
+	for (int i = 0; i < lines; ++i)
+		null_stream << "line " << i << " value " << i * i << std::endl;
+});
+MODERNCPP_BENCHMARK("Log", "Log() 10K lines + Flush", [] {
+	for (int i = 0; i < lines; ++i)
+		Log() << "line " << i << " value " << i * i << '\n';
+	LogSink::Instance().Flush();
+});
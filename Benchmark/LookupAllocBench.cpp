@@ -0,0 +1,143 @@
+// LookupAllocBench.cpp : lookups by const char* and string_view in string keyed containers, with and
+// without transparent comparators / hashers. Global operator new is replaced to count allocations,
+// the run fails if a lookup that is meant to be heterogeneous allocates anything.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp LookupAllocBench.cpp -o LookupAllocBench
+//
+// The keys are longer than the small string buffer, so every std::string built for a lookup allocates.
+
+#include "FlatHashMap.h"
+#include "Transparent.h"
+
+#include <map>
+#include <set>
+#include <new>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <unordered_map>
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	std::size_t allocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+	volatile std::size_t sink;
+
+	const int keyCount = 1000;
+	const int rounds = 200;
+
+	std::vector<std::string> MakeKeys()
+	{
+		std::vector<std::string> keys;
+		char buf[64];
+		for (int i = 0; i < keyCount; ++i)
+		{
+			std::snprintf(buf, sizeof(buf), "application/vnd.example.resource-%04d+json", i);
+			keys.emplace_back(buf);
+		}
+		return keys;
+	}
+
+	bool failed = false;
+
+	// ns and allocations per lookup, hits and misses alike
+	template <typename F>
+	void Run(const char* name, bool mustNotAllocate, F&& lookup)
+	{
+		const std::size_t before = allocations;
+		const auto start = bench_clock::now();
+		std::size_t found = 0;
+		for (int r = 0; r < rounds; ++r)
+			found += lookup();
+		const std::chrono::duration<double, std::nano> took = bench_clock::now() - start;
+		const double lookups = double(rounds) * 2 * keyCount;
+		const double perLookup = double(allocations - before) / lookups;
+		sink = found;
+
+		const bool bad = mustNotAllocate && allocations != before;
+		failed |= bad;
+		std::printf("%-48s %8.1f ns %8.2f allocs%s\n", name, took.count() / lookups, perLookup, bad ? "   FAIL" : "");
+	}
+}
+
+int main()
+{
+	const std::vector<std::string> keys = MakeKeys();
+
+	// probes: every key as const char* and as string_view, half of them with the last character changed
+	std::vector<std::string> missing = keys;
+	for (std::string& k : missing)
+		k.back() = '!';
+	std::vector<const char*> literals;
+	std::vector<std::string_view> views;
+	for (int i = 0; i < keyCount; ++i)
+	{
+		literals.push_back((i & 1 ? missing : keys)[i].c_str());
+		views.push_back((i & 1 ? missing : keys)[i]);
+	}
+
+	std::map<std::string, int> map;
+	StringMap<int> transparentMap;
+	std::set<std::string> set;
+	StringSet transparentSet;
+	std::unordered_map<std::string, int> unordered;
+	StringUnorderedMap<int> transparentUnordered;
+	FlatHashMap<std::string, int> flat;
+	for (int i = 0; i < keyCount; ++i)
+	{
+		map[keys[i]] = transparentMap[keys[i]] = unordered[keys[i]] = transparentUnordered[keys[i]] = flat[keys[i]] = i;
+		set.insert(keys[i]);
+		transparentSet.insert(keys[i]);
+	}
+
+	auto both = [&](auto&& contains) {
+		std::size_t found = 0;
+		for (int i = 0; i < keyCount; ++i)
+			found += contains(literals[i]) + contains(views[i]);
+		return found;
+	};
+
+	Run("std::map<std::string, int>", false, [&] {
+		return both([&](const auto& k) { return map.count(std::string(k)); });
+	});
+	Run("StringMap<int> (std::map, StringLess)", true, [&] {
+		return both([&](const auto& k) { return Contains(transparentMap, k); });
+	});
+	Run("std::set<std::string>", false, [&] {
+		return both([&](const auto& k) { return set.count(std::string(k)); });
+	});
+	Run("StringSet (std::set, StringLess)", true, [&] {
+		return both([&](const auto& k) { return Contains(transparentSet, k); });
+	});
+	Run("std::unordered_map<std::string, int>", false, [&] {
+		return both([&](const auto& k) { return unordered.count(std::string(k)); });
+	});
+	Run(TRANSPARENT::unordered_lookup ? "StringUnorderedMap<int>" : "StringUnorderedMap<int> (needs C++20)",
+		TRANSPARENT::unordered_lookup, [&] {
+		return both([&](const auto& k) { return Contains(transparentUnordered, k); });
+	});
+	Run("FlatHashMap<std::string, int>", true, [&] {
+		return both([&](const auto& k) { return Contains(flat, k); });
+	});
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+// MoveBench.cpp : std::vector<Cpp11> growing and being sorted, both of which relocate the elements
+// with Cpp11's move constructor / assignment. Global operator new is replaced to count allocations,
+// the run fails if relocating or sorting allocates anything beyond the vector's own buffer.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp MoveBench.cpp <moderncpp library> -o MoveBench
+//
+// A move that left members out rebuilt them from their initializers, one make_shared<Base>()
+// per element and move, and a throwing move made std::vector copy where it could.
+
+#include "Cpp11.h"
+
+#include <new>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	std::size_t allocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// std::pmr's default resource asks for an alignment, count those too
+void* operator new(std::size_t size, std::align_val_t align)
+{
+	++allocations;
+	const std::size_t a = (std::max)(static_cast<std::size_t>(align), sizeof(void*));
+	if (void* raw = std::malloc(size + a))
+	{
+		void* p = reinterpret_cast<void*>((reinterpret_cast<std::uintptr_t>(raw) + a) & ~(a - 1));
+		static_cast<void**>(p)[-1] = raw;
+		return p;
+	}
+	throw std::bad_alloc();
+}
+void operator delete(void* p, std::align_val_t) noexcept { if (p) std::free(static_cast<void**>(p)[-1]); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { if (p) std::free(static_cast<void**>(p)[-1]); }
+
+namespace
+{
+	volatile long sink;
+
+	const int objects = 100000;
+	const int rounds = 10;
+
+	bool failed = false;
+
+	// ns and allocations per element of measure, prepare is neither timed nor counted;
+	// the run fails when more than maxAllocations were made
+	template <typename Prepare, typename Measure>
+	void Run(const char* name, std::size_t maxAllocations, Prepare&& prepare, Measure&& measure)
+	{
+		double ns = 0;
+		std::size_t worst = 0;
+		for (int r = 0; r < rounds; ++r)
+		{
+			std::vector<Cpp11> v;
+			prepare(v);
+			const std::size_t before = allocations;
+			const auto start = bench_clock::now();
+			measure(v);
+			const std::chrono::duration<double, std::nano> took = bench_clock::now() - start;
+			ns += took.count();
+			worst = (std::max)(worst, allocations - before);
+			sink = v.back().getValue();
+		}
+
+		const bool bad = worst > maxAllocations;
+		failed |= bad;
+		std::printf("%-40s %8.1f ns %10.3f allocs%s\n", name, ns / rounds / objects, double(worst) / objects, bad ? "   FAIL" : "");
+	}
+
+	void Fill(std::vector<Cpp11>& v)
+	{
+		for (int i = 0; i < objects; ++i)
+		{
+			v.emplace_back(i, (i * 7919) % objects);
+			v.back().setValue((i * 7919) % objects);
+		}
+	}
+}
+
+int main()
+{
+	std::printf("std::vector<Cpp11>, %d elements, per element\n", objects);
+
+	auto none = [](std::vector<Cpp11>&) {};
+	auto filled = [](std::vector<Cpp11>& v) {
+		v.reserve(objects);
+		Fill(v);
+	};
+
+	// construction allocates (the shared Base), growth itself only the buffers
+	Run("push_back, growing", ~std::size_t(0), none, Fill);
+	Run("relocate (reserve twice the size)", 1, filled, [](std::vector<Cpp11>& v) { v.reserve(2 * objects); });
+	Run("sort by value", 0, filled, [](std::vector<Cpp11>& v) {
+		std::sort(v.begin(), v.end(), [](const Cpp11& a, const Cpp11& b) { return a.getValue() < b.getValue(); });
+	});
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+// PerfectHashBench.cpp : the Cpp11 color table three ways. Building it per instance, which the
+// compile-time PerfectHashMap never does, and looking colors up by name, one of them missing.
+
+#include "Benchmark.h"
+#include "FlatHashMap.h"
+#include "PerfectHash.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace MODERNCPP;
+using MODERNCPP::BENCH::DoNotOptimize;
+
+namespace
+{
+	constexpr auto colors = MakePerfectHashMap<std::string_view, std::string_view>({
+		{ "RED", "#FF0000" },
+		{ "GREEN", "#00FF00" },
+		{ "BLUE", "#0000FF" }
+	});
+
+	const std::unordered_map<std::string, std::string> unordered = { { "RED", "#FF0000" }, { "GREEN", "#00FF00" }, { "BLUE", "#0000FF" } };
+	const FlatHashMap<std::string, std::string> flat = { { "RED", "#FF0000" }, { "GREEN", "#00FF00" }, { "BLUE", "#0000FF" } };
+
+	const std::string_view names[] = { "RED", "GREEN", "BLUE", "BLACK" };
+	const int lookups = 100000;
+}
+
+MODERNCPP_BENCHMARK("ColorTable", "unordered_map build", [] {
+	std::unordered_map<std::string, std::string> u = { { "RED", "#FF0000" }, { "GREEN", "#00FF00" }, { "BLUE", "#0000FF" } };
+	DoNotOptimize(u.size());
+});
+MODERNCPP_BENCHMARK("ColorTable", "FlatHashMap build", [] {
+	FlatHashMap<std::string, std::string> u = { { "RED", "#FF0000" }, { "GREEN", "#00FF00" }, { "BLUE", "#0000FF" } };
+	DoNotOptimize(u.size());
+});
+
+MODERNCPP_BENCHMARK("ColorTable", "unordered_map find 100K", [] {
+	std::size_t found = 0;
+	for (int i = 0; i < lookups; ++i)
+		found += unordered.count(std::string(names[i & 3]));
+	DoNotOptimize(found);
+});
+MODERNCPP_BENCHMARK("ColorTable", "FlatHashMap find 100K", [] {
+	std::size_t found = 0;
+	for (int i = 0; i < lookups; ++i)
+		found += flat.count(names[i & 3]);
+	DoNotOptimize(found);
+});
+MODERNCPP_BENCHMARK("ColorTable", "PerfectHashMap find 100K", [] {
+	std::size_t found = 0;
+	for (int i = 0; i < lookups; ++i)
+		found += colors.contains(names[i & 3]);
+	DoNotOptimize(found);
+});
@@ -0,0 +1,53 @@
+// RandomBench.cpp : bulk uniform numbers, <random> distributions vs FillUniform on Xoshiro256x4,
+// and the per call cost RandomNumberGenerator() used to pay for a fresh std::random_device + mt19937.
+
+#include "Benchmark.h"
+#include "Random.h"
+
+#include <random>
+#include <vector>
+#include <cstddef>
+
+using namespace MODERNCPP;
+using MODERNCPP::BENCH::DoNotOptimize;
+
+namespace
+{
+	const std::size_t count = 1 << 20;
+
+	std::vector<int> ints(count);
+	std::vector<double> doubles(count);
+}
+
+MODERNCPP_BENCHMARK("Random", "mt19937 uniform_int_distribution 1M", [] {
+	std::mt19937& gen = ThreadLocalEngine<std::mt19937>();
+	std::uniform_int_distribution<int> dis(1, 6);
+	for (int& i : ints)
+		i = dis(gen);
+	DoNotOptimize(ints.data());
+});
+MODERNCPP_BENCHMARK("Random", "FillUniform int 1M", [] {
+	FillUniform(ints, 1, 6);
+	DoNotOptimize(ints.data());
+});
+
+MODERNCPP_BENCHMARK("Random", "mt19937 uniform_real_distribution 1M", [] {
+	std::mt19937& gen = ThreadLocalEngine<std::mt19937>();
+	std::uniform_real_distribution<double> dis(0.0, 1.0);
+	for (double& d : doubles)
+		d = dis(gen);
+	DoNotOptimize(doubles.data());
+});
+MODERNCPP_BENCHMARK("Random", "FillUniform double 1M", [] {
+	FillUniform(doubles, 0.0, 1.0);
+	DoNotOptimize(doubles.data());
+});
+
+MODERNCPP_BENCHMARK("Random", "random_device + mt19937 per number", [] {
+	std::random_device rd;
+	std::mt19937 gen(rd());
+	DoNotOptimize(std::uniform_int_distribution<>(1, 6)(gen));
+});
+MODERNCPP_BENCHMARK("Random", "ThreadLocalEngine per number", [] {
+	DoNotOptimize(std::uniform_int_distribution<>(1, 6)(ThreadLocalEngine<std::mt19937>()));
+});
@@ -0,0 +1,135 @@
+// RegexBench.cpp : DfaRegex vs std::regex on a 2 MB text, with RegularExpression()'s three patterns.
+// std::regex is slow enough here that its cases are capped at a few iterations.
+// The streamed replace is checked against std::regex_replace piece size by piece size, a mismatch
+// throws out of its case and fails the run.
+
+#include "Benchmark.h"
+#include "Regex.h"
+
+#include <regex>
+#include <string>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+
+using namespace MODERNCPP;
+using MODERNCPP::BENCH::DoNotOptimize;
+
+namespace
+{
+	const std::size_t slow = 3;
+
+	// prose without the phrase, so the icase search has to scan all of it
+	const std::string& Text()
+	{
+		static const std::string text = [] {
+			const std::string line = "Some people, when confronted with a problem, think "
+				"\"I know, I'll use something clever.\" Now they have two problems.\n";
+			std::string t;
+			while (t.size() < (2u << 20))
+				t += line;
+			return t;
+		}();
+		return text;
+	}
+
+	// one long line with an error every 100 bytes and no timeout: every error starts a walk of .* to the
+	// end of the line, the worst case for trying the start positions one by one (std::regex recurses
+	// per byte and runs out of stack on a line this long, so it has no case here)
+	const std::string& ErrorLine()
+	{
+		static const std::string text = [] {
+			std::string t;
+			while (t.size() < (256u << 10))
+				t += "error: the connection to the upstream server was reset by peer, retrying in a moment. ";
+			return t + '\n';
+		}();
+		return text;
+	}
+
+	const auto icase = std::regex_constants::ECMAScript | std::regex_constants::icase;
+
+	void StreamReplace(std::string_view fmt)
+	{
+		const std::size_t piece = 64 * 1024;
+		std::size_t bytes = 0;
+		RegexReplaceStream replace("(\\w{7,})", fmt, [&bytes](std::string_view out) { bytes += out.size(); });
+		for (std::size_t pos = 0; pos < Text().size(); pos += piece)
+			replace.write(std::string_view(Text()).substr(pos, piece));
+		replace.finish();
+		DoNotOptimize(bytes);
+	}
+
+	// pieces of 1 byte, of odd sizes and of 64 KB put match starts, matches in progress and the text
+	// held back across every kind of boundary
+	void CheckStream(const std::string& pattern, std::string_view fmt)
+	{
+		const std::string text = Text().substr(0, 150 * 1024);
+		const std::string want = std::regex_replace(text, RegexCache::Instance().Regex(pattern), std::string(fmt));
+		for (const std::size_t piece : { std::size_t(1), std::size_t(7), std::size_t(4093), std::size_t(64 * 1024) })
+		{
+			std::string got;
+			RegexReplaceStream replace(pattern, fmt, [&got](std::string_view out) { got += out; });
+			for (std::size_t pos = 0; pos < text.size(); pos += piece)
+				replace.write(std::string_view(text).substr(pos, piece));
+			replace.finish();
+			if (got != want)
+				throw std::logic_error("RegexReplaceStream " + pattern + " " + std::string(fmt)
+					+ " differs from std::regex_replace in pieces of " + std::to_string(piece));
+		}
+	}
+}
+
+MODERNCPP_BENCHMARK("Regex", "std::regex search icase", [] {
+	DoNotOptimize(std::regex_search(Text(), RegexCache::Instance().Regex("REGULAR EXPRESSIONS", icase)));
+}, slow);
+MODERNCPP_BENCHMARK("Regex", "DfaRegex search icase", [] {
+	DoNotOptimize(RegexCache::Instance().Dfa("REGULAR EXPRESSIONS", icase).search(Text()));
+});
+
+MODERNCPP_BENCHMARK("Regex", "std::regex words", [] {
+	const std::regex& re = RegexCache::Instance().Regex("(\\S+)");
+	DoNotOptimize(std::distance(std::sregex_iterator(Text().begin(), Text().end(), re), std::sregex_iterator()));
+}, slow);
+MODERNCPP_BENCHMARK("Regex", "DfaRegex words", [] {
+	const DfaRegex& re = RegexCache::Instance().Dfa("(\\S+)");
+	DoNotOptimize(std::distance(DfaRegexIterator(Text(), re), DfaRegexIterator()));
+});
+
+MODERNCPP_BENCHMARK("Regex", "std::regex replace", [] {
+	DoNotOptimize(std::regex_replace(Text(), RegexCache::Instance().Regex("(\\w{7,})"), "[$&]"));
+}, slow);
+MODERNCPP_BENCHMARK("Regex", "DfaRegex replace", [] {
+	DoNotOptimize(RegexCache::Instance().Dfa("(\\w{7,})").replace(Text(), "[$&]"));
+});
+
+MODERNCPP_BENCHMARK("Regex", "DfaRegex search error.*timeout", [] {
+	DoNotOptimize(RegexCache::Instance().Dfa("error.*timeout").search(ErrorLine()));
+}, slow);
+
+// the same output in 64 KB pieces, never all of it at once
+MODERNCPP_BENCHMARK("Regex", "RegexReplaceStream replace", [] {
+	StreamReplace("[$&]");
+});
+MODERNCPP_BENCHMARK("Regex", "RegexReplaceStream replace $1", [] {
+	StreamReplace("[$1]");
+});
+MODERNCPP_BENCHMARK("Regex", "RegexReplaceStream check", [] {
+	CheckStream("(\\w{7,})", "[$&]");
+	CheckStream("(\\w{7,})", "[$1]");
+	CheckStream("(\\w*)", "[$&]");				// matches empty between the words
+	CheckStream("(\\w*)", "<$1>");
+}, slow);
+
+// what RegularExpression() paid per call before the cache
+MODERNCPP_BENCHMARK("Regex", "std::regex construct x3", [] {
+	std::regex a("REGULAR EXPRESSIONS", icase), b("(\\S+)"), c("(\\w{7,})");
+	DoNotOptimize(a); DoNotOptimize(b); DoNotOptimize(c);
+});
+MODERNCPP_BENCHMARK("Regex", "RegexCache lookup x3", [] {
+	RegexCache& cache = RegexCache::Instance();
+	DoNotOptimize(&cache.Dfa("REGULAR EXPRESSIONS", icase));
+	DoNotOptimize(&cache.Dfa("(\\S+)"));
+	DoNotOptimize(&cache.Dfa("(\\w{7,})"));
+});
@@ -0,0 +1,178 @@
+// RingBufferBench.cpp : SPSC / MPMC ring buffers vs a mutex + condition_variable queue.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp RingBufferBench.cpp -pthread -o RingBufferBench
+//
+// throughput: one producer streams N ints to one consumer
+// latency:    two threads ping-pong one int through a pair of queues, round trip time
+
+#include "RingBuffer.h"
+
+#include <queue>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <condition_variable>
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	// the baseline: what ProducerConsumer would look like with classic locking
+	template <typename T>
+	class MutexQueue {
+	public:
+		explicit MutexQueue(std::size_t) {}
+
+		bool try_push(const T& v)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_queue.push(v);
+			}
+			m_cv.notify_one();
+			return true;
+		}
+
+		bool try_pop(T& out)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait(lock, [this] { return !m_queue.empty(); });
+			out = m_queue.front();
+			m_queue.pop();
+			return true;
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::queue<T> m_queue;
+	};
+
+	template <typename Queue>
+	double Throughput(std::size_t nitems, std::size_t capacity)
+	{
+		Queue q(capacity);
+		const auto start = bench_clock::now();
+
+		std::thread producer([&] {
+			for (std::size_t i = 0; i < nitems; ++i)
+				while (!q.try_push(static_cast<int>(i)))
+					std::this_thread::yield();
+		});
+
+		std::thread consumer([&] {
+			int v;
+			for (std::size_t i = 0; i < nitems; ++i)
+				while (!q.try_pop(v))
+					std::this_thread::yield();
+		});
+
+		producer.join();
+		consumer.join();
+		const std::chrono::duration<double> secs = bench_clock::now() - start;
+		return nitems / secs.count();
+	}
+
+	template <typename Queue>
+	double BulkThroughput(std::size_t nitems, std::size_t capacity, std::size_t batch)
+	{
+		Queue q(capacity);
+		const auto start = bench_clock::now();
+
+		std::thread producer([&] {
+			std::vector<int> buf(batch);
+			for (std::size_t i = 0; i < nitems; ) {
+				const std::size_t n = std::min(batch, nitems - i);
+				for (std::size_t k = 0; k < n; ++k)
+					buf[k] = static_cast<int>(i + k);
+				std::size_t done = 0;
+				while (done < n)
+					if (std::size_t m = q.push_bulk(buf.data() + done, n - done))
+						done += m;
+					else
+						std::this_thread::yield();
+				i += n;
+			}
+		});
+
+		std::thread consumer([&] {
+			std::vector<int> buf(batch);
+			for (std::size_t i = 0; i < nitems; )
+				if (std::size_t m = q.pop_bulk(buf.data(), batch))
+					i += m;
+				else
+					std::this_thread::yield();
+		});
+
+		producer.join();
+		consumer.join();
+		const std::chrono::duration<double> secs = bench_clock::now() - start;
+		return nitems / secs.count();
+	}
+
+	struct Latency {
+		double median_ns, p99_ns;
+	};
+
+	template <typename Queue>
+	Latency RoundTrip(std::size_t rounds)
+	{
+		Queue ping(64), pong(64);
+		std::vector<double> samples;
+		samples.reserve(rounds);
+
+		std::thread echo([&] {
+			int v;
+			for (std::size_t i = 0; i < rounds; ++i) {
+				while (!ping.try_pop(v))
+					std::this_thread::yield();
+				while (!pong.try_push(v))
+					std::this_thread::yield();
+			}
+		});
+
+		int v;
+		for (std::size_t i = 0; i < rounds; ++i) {
+			const auto t0 = bench_clock::now();
+			while (!ping.try_push(static_cast<int>(i)))
+				std::this_thread::yield();
+			while (!pong.try_pop(v))
+				std::this_thread::yield();
+			samples.push_back(std::chrono::duration<double, std::nano>(bench_clock::now() - t0).count());
+		}
+		echo.join();
+
+		std::sort(samples.begin(), samples.end());
+		return { samples[samples.size() / 2], samples[samples.size() * 99 / 100] };
+	}
+
+	template <typename Queue>
+	void Report(const char* name, std::size_t nitems, std::size_t rounds)
+	{
+		const double tput = Throughput<Queue>(nitems, 1024);
+		const Latency lat = RoundTrip<Queue>(rounds);
+		std::printf("%-22s %12.2f %14.0f %14.0f\n", name, tput / 1e6, lat.median_ns, lat.p99_ns);
+	}
+}
+
+int main()
+{
+	const std::size_t nitems = 10'000'000;
+	const std::size_t rounds = 100'000;
+
+	std::printf("%-22s %12s %14s %14s\n", "queue", "Mitems/s", "rtt median ns", "rtt p99 ns");
+	Report<SpscRingBuffer<int>>("SpscRingBuffer", nitems, rounds);
+	Report<MpmcRingBuffer<int>>("MpmcRingBuffer", nitems, rounds);
+	Report<MutexQueue<int>>("mutex+condvar queue", nitems, rounds);
+
+	std::printf("%-22s %12.2f\n", "SpscRingBuffer bulk/64",
+		BulkThroughput<SpscRingBuffer<int>>(nitems, 1024, 64) / 1e6);
+	std::printf("%-22s %12.2f\n", "MpmcRingBuffer bulk/64",
+		BulkThroughput<MpmcRingBuffer<int>>(nitems, 1024, 64) / 1e6);
+	return 0;
+}
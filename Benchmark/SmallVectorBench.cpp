@@ -0,0 +1,57 @@
+// SmallVectorBench.cpp : the nine values every Cpp11 starts with, in a std::vector (one allocation
+// per object) and in the SmallVector that now holds them inline, and whole Cpp11 objects built from a list.
+
+#include "Benchmark.h"
+#include "Cpp11.h"
+#include "SmallVector.h"
+
+#include <vector>
+
+using namespace MODERNCPP;
+using MODERNCPP::BENCH::DoNotOptimize;
+
+namespace
+{
+	const int objects = 10000;
+}
+
+MODERNCPP_BENCHMARK("SmallVector", "std::vector<int> 9 values x10K", [] {
+	long sum = 0;
+	for (int i = 0; i < objects; ++i)
+	{
+		std::vector<int> v = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		sum += v[i % 9];
+		DoNotOptimize(v.data());
+	}
+	DoNotOptimize(sum);
+});
+MODERNCPP_BENCHMARK("SmallVector", "SmallVector<int, 16> 9 values x10K", [] {
+	long sum = 0;
+	for (int i = 0; i < objects; ++i)
+	{
+		SmallVector<int, 16> v = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		sum += v[i % 9];
+		DoNotOptimize(v.data());
+	}
+	DoNotOptimize(sum);
+});
+MODERNCPP_BENCHMARK("SmallVector", "SmallVector<int, 4> 9 values x10K (spills)", [] {
+	long sum = 0;
+	for (int i = 0; i < objects; ++i)
+	{
+		SmallVector<int, 4> v = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		sum += v[i % 9];
+		DoNotOptimize(v.data());
+	}
+	DoNotOptimize(sum);
+});
+
+MODERNCPP_BENCHMARK("SmallVector", "Cpp11 from list x10K", [] {
+	long sum = 0;
+	for (int i = 0; i < objects; ++i)
+	{
+		Cpp11 c = { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 1, 2 };		// longer than the defaults, grows
+		sum += c.getLength();
+	}
+	DoNotOptimize(sum);
+});
@@ -0,0 +1,164 @@
+// TextScanBench.cpp : ScanText over a large log in GB/s and the peak resident set it takes, on a
+// MappedFile and on a std::string read with an ifstream, in one chunk and in parallel chunks.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp TextScanBench.cpp <moderncpp library> -o TextScanBench
+//   TextScanBench [MB, default 256]
+//   TextScanBench --file <path>		(an existing text file, left as it is)
+//
+// The generated log goes under temp_directory_path() and is removed at the end; it is in the page
+// cache by then, so this measures the scan and not the disk. The peak resident set only grows, the
+// mapped runs go first. The run fails if two ways of scanning disagree.
+
+#include "MappedFile.h"
+#include "TextScan.h"
+#include "ThreadPool.h"
+#include "Regex.h"
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace MODERNCPP;
+namespace fs = std::filesystem;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	const int rounds = 3;
+	const std::size_t longer = 24;		// the time stamps are 24, the trace ids are longer
+
+	double PeakRssMB()
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize / 1048576.0;
+#else
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+		return usage.ru_maxrss / 1048576.0;		// bytes
+#else
+		return usage.ru_maxrss / 1024.0;		// KB
+#endif
+#endif
+	}
+
+	// lines of a service log, now and then a timeout and a long identifier
+	void Generate(const fs::path& path, std::size_t megabytes)
+	{
+		static const char* const words[] = { "request", "GET", "POST", "/api/v1/orders", "status=200", "status=404",
+			"user", "latency_ms=12", "cache", "hit", "miss", "retry", "worker", "connection", "closed", "timeout" };
+		std::mt19937 random(42);
+		std::ofstream out(path, std::ios::binary);
+		std::string line;
+		for (std::size_t written = 0; written < megabytes << 20; written += line.size())
+		{
+			line = "2024-05-01T12:00:00.000Z INFO";
+			for (unsigned n = 4 + random() % 12; n--; )
+			{
+				line += ' ';
+				line += words[random() % std::size(words)];
+			}
+			if (random() % 64 == 0)
+				line += " trace=" + std::to_string(random()) + std::to_string(random());
+			line += '\n';
+			out << line;
+		}
+	}
+
+	template <typename F>
+	TextStats Run(const char* name, std::size_t bytes, F&& scan)
+	{
+		TextStats stats;
+		double best = 1e300;
+		for (int r = 0; r < rounds; ++r)
+		{
+			const auto start = bench_clock::now();
+			stats = scan();
+			const std::chrono::duration<double> took = bench_clock::now() - start;
+			best = (std::min)(best, took.count());
+		}
+		std::printf("%-36s %10zu words %8zu matches %8zu long %7.1f ms %6.2f GB/s %8.1f MB peak RSS\n",
+			name, stats.words, stats.matches, stats.longWords.size(), best * 1e3, bytes / best / 1e9, PeakRssMB());
+		return stats;
+	}
+
+	bool Same(const TextStats& a, const TextStats& b)
+	{
+		return a.bytes == b.bytes && a.words == b.words && a.matches == b.matches && a.longWords == b.longWords;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	fs::path path;
+	bool generated = false;
+	if (argc > 2 && std::strcmp(argv[1], "--file") == 0)
+		path = argv[2];
+	else
+	{
+		const std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+		path = fs::temp_directory_path() / "TextScanBench.log";
+		const auto start = bench_clock::now();
+		Generate(path, megabytes);
+		const std::chrono::duration<double> took = bench_clock::now() - start;
+		std::printf("generated %s (%zu MB) in %.1f s\n", path.string().c_str(), megabytes, took.count());
+		generated = true;
+	}
+
+	const std::size_t bytes = fs::file_size(path);
+	const DfaRegex& pattern = RegexCache::Instance().Dfa("timeout");
+	std::printf("%.1f MB, %u threads, chunks of %zu MB, words longer than %zu, peak RSS %.1f MB at the start\n",
+		bytes / 1048576.0, ThreadPool::Instance().size() + 1, default_chunk >> 20, longer, PeakRssMB());
+
+	bool bad = false;
+	{
+		// the views of the results point into the mapping, it outlives them
+		MappedFile file(path);
+		const TextStats mapped = Run("MappedFile, chunks", bytes, [&] { return ScanText(file, pattern, longer); });
+		const TextStats serial = Run("MappedFile, one chunk", bytes, [&] { return ScanText(file, pattern, longer, bytes + 1); });
+		bad |= !Same(mapped, serial);
+
+		std::string text;
+		const auto start = bench_clock::now();
+		{
+			std::ifstream in(path, std::ios::binary);
+			text.resize(bytes);
+			in.read(&text[0], static_cast<std::streamsize>(bytes));
+		}
+		const std::chrono::duration<double> took = bench_clock::now() - start;
+		std::printf("%-36s %62.1f ms %6.2f GB/s %8.1f MB peak RSS\n",
+			"ifstream into a std::string", took.count() * 1e3, bytes / took.count() / 1e9, PeakRssMB());
+
+		const TextStats chunks = Run("std::string, chunks", bytes, [&] { return ScanText(text, pattern, longer); });
+		const TextStats whole = Run("std::string, one chunk", bytes, [&] { return ScanText(text, pattern, longer, bytes + 1); });
+
+		// the words point into different copies of the text, their contents compare
+		bad |= !Same(mapped, chunks) || !Same(mapped, whole);
+	}
+	if (bad)
+		std::printf("FAIL: the scans disagree\n");
+
+	if (generated)
+		fs::remove(path);
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,104 @@
+// ThreadPoolBench.cpp : cost per task on the work-stealing pool vs a thread per call.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp ThreadPoolBench.cpp ../ModernCpp/ThreadPool.cpp -pthread -o ThreadPoolBench
+//
+// thread-per-call: what ParallelThreads used to do, hardware_concurrency() fresh threads per call
+// submit:          one future per task
+// parallel_for:    one call split into chunks, the caller helps
+
+#include "ThreadPool.h"
+
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <atomic>
+#include <functional>
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	std::atomic<std::size_t> g_sink{ 0 };
+
+	// a task small enough that scheduling dominates
+	void TinyWork(std::size_t bi, std::size_t ei)
+	{
+		std::size_t acc = 0;
+		for (std::size_t i = bi; i < ei; ++i)
+			acc += i * i;
+		g_sink.fetch_add(acc, std::memory_order_relaxed);
+	}
+
+	template <typename F>
+	double NanosPerTask(std::size_t ntasks, F&& run)
+	{
+		const auto start = bench_clock::now();
+		run();
+		return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count() / ntasks;
+	}
+
+	// the old ParallelThreads pattern
+	void ThreadPerCall(std::size_t nloop)
+	{
+		const std::size_t nthreads = std::thread::hardware_concurrency();
+		std::vector<std::thread> threads(nthreads);
+		std::mutex critical;
+		for (std::size_t t = 0; t < nthreads; t++)
+			threads[t] = std::thread(std::bind([&](std::size_t bi, std::size_t ei) {
+				std::lock_guard<std::mutex> lock(critical);
+				TinyWork(bi, ei);
+			}, t * nloop / nthreads, (t + 1) == nthreads ? nloop : (t + 1) * nloop / nthreads));
+		for (auto& t : threads)
+			t.join();
+	}
+}
+
+int main()
+{
+	ThreadPool& pool = ThreadPool::Instance();
+	const std::size_t calls = 2'000;
+	const std::size_t ntasks = 200'000;
+
+	std::printf("workers: %u\n", pool.size());
+	std::printf("%-34s %12s\n", "pattern", "ns/task");
+
+	const std::size_t nthreads = std::thread::hardware_concurrency();
+	std::printf("%-34s %12.1f\n", "thread-per-call (ParallelThreads)",
+		NanosPerTask(calls * nthreads, [&] {
+			for (std::size_t c = 0; c < calls; ++c)
+				ThreadPerCall(11);
+		}));
+
+	std::printf("%-34s %12.1f\n", "pool parallel_for per call",
+		NanosPerTask(calls * nthreads, [&] {
+			for (std::size_t c = 0; c < calls; ++c)
+				pool.parallel_for(0, 11, TinyWork, (11 + nthreads - 1) / nthreads);
+		}));
+
+	std::printf("%-34s %12.1f\n", "pool submit + future::get",
+		NanosPerTask(ntasks, [&] {
+			std::vector<std::future<void>> futures;
+			futures.reserve(ntasks);
+			for (std::size_t i = 0; i < ntasks; ++i)
+				futures.push_back(pool.submit(TinyWork, i, i + 16));
+			for (auto& f : futures)
+				f.get();
+		}));
+
+	std::printf("%-34s %12.1f\n", "pool parallel_for grain 16",
+		NanosPerTask(ntasks, [&] {
+			pool.parallel_for(0, ntasks * 16, TinyWork, 16);
+		}));
+
+	std::printf("%-34s %12.1f\n", "nested parallel_for from tasks",
+		NanosPerTask(ntasks, [&] {
+			pool.parallel_for(0, 64, [&](std::size_t, std::size_t) {
+				pool.parallel_for(0, ntasks / 64 * 16, TinyWork, 16);
+			}, 1);
+		}));
+
+	return g_sink.load() == 42 ? 1 : 0;		// keep the work observable
+}
@@ -0,0 +1,117 @@
+// TokenizerBench.cpp : WordTokenizer at every SIMD level vs the "(\\S+)" regex scans, in GB/s.
+//
+//   g++ -O2 -std=c++17 -I../ModernCpp TokenizerBench.cpp ../ModernCpp/Tokenizer.cpp ../ModernCpp/Regex.cpp -o TokenizerBench
+//
+// Every pass counts the words and sums the lengths of those longer than 6 characters,
+// which is what RegularExpression() does with them. The counts are checked against std::regex.
+
+#include "Regex.h"
+#include "Tokenizer.h"
+
+#include <regex>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace MODERNCPP;
+using bench_clock = std::chrono::steady_clock;
+
+namespace
+{
+	struct Tally {
+		std::size_t words = 0;
+		std::size_t longChars = 0;
+
+		void Add(std::size_t length)
+		{
+			++words;
+			if (length > 6)
+				longChars += length;
+		}
+		bool operator==(const Tally& rhs) const { return words == rhs.words && longChars == rhs.longChars; }
+	};
+
+	// prose with every kind of whitespace the tokenizer has to know about
+	std::string MakeText(std::size_t bytes)
+	{
+		const std::string line = "Some people, when confronted with a problem,\tthink "
+			"\"I know, I'll use regular expressions.\"\r\nNow  they have\vtwo problems.\f\n";
+		std::string text;
+		text.reserve(bytes + line.size());
+		while (text.size() < bytes)
+			text += line;
+		return text;
+	}
+
+	Tally Tokenize(std::string_view text, SimdLevel level)
+	{
+		Tally t;
+		WordTokenizer words(text, level);
+		for (std::string_view w; words.next(w); )
+			t.Add(w.size());
+		return t;
+	}
+
+	Tally Dfa(std::string_view text)
+	{
+		Tally t;
+		for (DfaRegexIterator i(text, RegexCache::Instance().Dfa("(\\S+)")), end; i != end; ++i)
+			t.Add(i->size());
+		return t;
+	}
+
+	Tally StdRegex(const std::string& text)
+	{
+		Tally t;
+		const std::regex& re = RegexCache::Instance().Regex("(\\S+)");
+		for (std::sregex_iterator i(text.begin(), text.end(), re), end; i != end; ++i)
+			t.Add(static_cast<std::size_t>(i->length()));
+		return t;
+	}
+
+	// best of rounds, in GB/s
+	template <typename F>
+	double Throughput(std::size_t bytes, int rounds, F&& pass)
+	{
+		double best = 0;
+		for (int r = 0; r < rounds; ++r)
+		{
+			const auto start = bench_clock::now();
+			const Tally t = pass();
+			const double s = std::chrono::duration<double>(bench_clock::now() - start).count();
+			if (t.words == 0)
+				std::abort();
+			best = (std::max)(best, bytes / s / 1e9);
+		}
+		return best;
+	}
+}
+
+int main()
+{
+	const std::string big = MakeText(256u << 20);
+	const std::string small = big.substr(0, 4u << 20);		// std::regex would take minutes on the big one
+
+	const Tally expected = StdRegex(small);
+	bool ok = Dfa(small) == expected;
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 })
+		ok = ok && Tokenize(small, level) == expected;
+	std::printf("detected: %s, results %s std::regex\n", ToString(DetectSimd()), ok ? "match" : "DIFFER FROM");
+
+	std::printf("%-28s %10s %10s\n", "scan", "MB", "GB/s");
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 })
+	{
+		if (level > DetectSimd())
+			continue;
+		const std::string name = std::string("WordTokenizer ") + ToString(level);
+		std::printf("%-28s %10zu %10.3f\n", name.c_str(), big.size() >> 20,
+			Throughput(big.size(), 5, [&] { return Tokenize(big, level); }));
+	}
+	std::printf("%-28s %10zu %10.3f\n", "DfaRegexIterator", small.size() >> 20,
+		Throughput(small.size(), 3, [&] { return Dfa(small); }));
+	std::printf("%-28s %10zu %10.3f\n", "std::sregex_iterator", small.size() >> 20,
+		Throughput(small.size(), 1, [&] { return StdRegex(small); }));
+	return ok ? 0 : 1;
+}
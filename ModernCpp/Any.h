@@ -0,0 +1,300 @@
+#pragma once
+
+#ifndef __MODERN_CPP_ANY_H
+#define __MODERN_CPP_ANY_H
+
+#include <new>
+#include <any>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+// std::any with an inline buffer of a chosen size and no RTTI: a value of up to Size bytes lives inside
+// the object, only a larger one goes to the heap, and the type check is one pointer compare.
+//
+//   SmallAny<64> a = std::string("no heap block");		// std::any allocates for this
+//   if (const std::string* s = AnyCast<std::string>(&a))
+//       Use(*s);
+//
+// SmallAny is copyable and takes copyable values, UniqueAny is move-only and takes move-only values too.
+// https://en.cppreference.com/w/cpp/utility/any
+
+namespace MODERNCPP
+{
+	// the address of a variable of its own for every type: a constant, no typeid needed. Unique within a
+	// program; a type seen by two DLLs on Windows gets one id in each.
+	using TypeId = const void*;
+
+	namespace DETAIL
+	{
+		// not const: the linker may fold identical read-only constants into one (MSVC's /OPT:ICF), a
+		// writable variable keeps an address of its own
+		template <typename T>
+		struct TypeTag {
+			inline static char id;
+		};
+	}
+
+	template <typename T>
+	inline constexpr TypeId type_id = &DETAIL::TypeTag<T>::id;
+
+	namespace DETAIL
+	{
+		// what a stored type needs done, one table per type and storage
+		struct AnyOps {
+			TypeId type;
+			void (*destroy)(void* storage) noexcept;			// null: nothing to destroy
+			void (*relocate)(void* from, void* to) noexcept;	// null: moving the bytes moves the value
+			void (*copy)(const void* from, void* to);			// null: copying the bytes copies the value
+		};
+
+		// inline the storage is the value, otherwise it holds a pointer to it
+		template <typename T, bool Inline, bool Copyable>
+		struct AnyOpsFor {
+			static void Destroy(void* storage) noexcept
+			{
+				if constexpr (Inline)
+					static_cast<T*>(storage)->~T();
+				else
+					delete *static_cast<T**>(storage);
+			}
+
+			static void Relocate(void* from, void* to) noexcept
+			{
+				T& value = *static_cast<T*>(from);
+				::new (to) T(std::move(value));
+				value.~T();
+			}
+
+			static void Copy(const void* from, void* to)
+			{
+				if constexpr (Inline)
+					::new (to) T(*static_cast<const T*>(from));
+				else
+					*static_cast<T**>(to) = new T(**static_cast<T* const*>(from));
+			}
+
+			static constexpr AnyOps Make()
+			{
+				AnyOps ops{ type_id<T>, nullptr, nullptr, nullptr };
+				if constexpr (!Inline || !std::is_trivially_destructible_v<T>)
+					ops.destroy = &Destroy;
+				if constexpr (Inline && !std::is_trivially_copyable_v<T>)
+					ops.relocate = &Relocate;
+				if constexpr (Copyable && (!Inline || !std::is_trivially_copyable_v<T>))
+					ops.copy = &Copy;
+				return ops;
+			}
+
+			static constexpr AnyOps ops = Make();
+		};
+
+		// the value and its table; the copy is only reachable through a copyable BasicAny
+		template <std::size_t Size>
+		class AnyStorage {
+		protected:
+
+			AnyStorage() noexcept = default;
+			AnyStorage(const AnyStorage& other) { CopyFrom(other); }
+			AnyStorage(AnyStorage&& other) noexcept { MoveFrom(other); }
+			~AnyStorage() { Reset(); }
+
+			AnyStorage& operator=(const AnyStorage& other)
+			{
+				if (this != &other)
+				{
+					AnyStorage copy(other);
+					Reset();
+					MoveFrom(copy);
+				}
+				return *this;
+			}
+
+			AnyStorage& operator=(AnyStorage&& other) noexcept
+			{
+				if (this != &other)
+				{
+					Reset();
+					MoveFrom(other);
+				}
+				return *this;
+			}
+
+			void Reset() noexcept
+			{
+				if (m_ops && m_ops->destroy)
+					m_ops->destroy(m_buffer);
+				m_ops = nullptr;
+			}
+
+			void MoveFrom(AnyStorage& other) noexcept
+			{
+				if (!other.m_ops)
+					return;
+				if (other.m_ops->relocate)
+					other.m_ops->relocate(other.m_buffer, m_buffer);
+				else
+					std::memcpy(m_buffer, other.m_buffer, Size);
+				m_ops = std::exchange(other.m_ops, nullptr);
+			}
+
+			void CopyFrom(const AnyStorage& other)
+			{
+				if (!other.m_ops)
+					return;
+				if (other.m_ops->copy)
+					other.m_ops->copy(other.m_buffer, m_buffer);
+				else
+					std::memcpy(m_buffer, other.m_buffer, Size);
+				m_ops = other.m_ops;
+			}
+
+			alignas(std::max_align_t) unsigned char m_buffer[Size];
+			const AnyOps* m_ops = nullptr;
+		};
+
+		// deletes the copy of a move-only BasicAny, whose defaulted members follow it
+		template <bool Copyable>
+		struct AnyCopy {};
+
+		template <>
+		struct AnyCopy<false> {
+			AnyCopy() = default;
+			AnyCopy(const AnyCopy&) = delete;
+			AnyCopy(AnyCopy&&) = default;
+			AnyCopy& operator=(const AnyCopy&) = delete;
+			AnyCopy& operator=(AnyCopy&&) = default;
+		};
+
+		template <typename T>
+		struct IsInPlaceType : std::false_type {};
+		template <typename T>
+		struct IsInPlaceType<std::in_place_type_t<T>> : std::true_type {};
+	}
+
+	template <std::size_t Size, bool Copyable>
+	class BasicAny : private DETAIL::AnyStorage<Size>, private DETAIL::AnyCopy<Copyable> {
+		static_assert(Size >= sizeof(void*), "BasicAny needs room for a pointer to a value on the heap");
+
+		using Storage = DETAIL::AnyStorage<Size>;
+
+		// inline values must move without throwing, like std::any's, so that moving a BasicAny can not throw
+		template <typename T>
+		static constexpr bool fits_inline = sizeof(T) <= Size && alignof(T) <= alignof(std::max_align_t)
+			&& std::is_nothrow_move_constructible_v<T>;
+
+		template <typename T>
+		using Accepts = std::enable_if_t<!std::is_same_v<std::decay_t<T>, BasicAny> && !DETAIL::IsInPlaceType<std::decay_t<T>>::value>;
+
+	public:
+
+		static constexpr std::size_t inline_size = Size;
+
+		BasicAny() noexcept = default;
+
+		template <typename T, typename = Accepts<T>>
+		BasicAny(T&& value) { emplace<std::decay_t<T>>(std::forward<T>(value)); }
+
+		template <typename T, typename... Args>
+		explicit BasicAny(std::in_place_type_t<T>, Args&&... args) { emplace<T>(std::forward<Args>(args)...); }
+
+		template <typename T, typename = Accepts<T>>
+		BasicAny& operator=(T&& value)
+		{
+			*this = BasicAny(std::forward<T>(value));
+			return *this;
+		}
+
+		template <typename T, typename... Args>
+		std::decay_t<T>& emplace(Args&&... args)
+		{
+			using V = std::decay_t<T>;
+			static_assert(!Copyable || std::is_copy_constructible_v<V>, "SmallAny holds copyable values, UniqueAny takes the others");
+
+			this->Reset();
+			V* value;
+			if constexpr (fits_inline<V>)
+				value = ::new (static_cast<void*>(this->m_buffer)) V(std::forward<Args>(args)...);
+			else
+			{
+				value = new V(std::forward<Args>(args)...);
+				::new (static_cast<void*>(this->m_buffer)) V*(value);
+			}
+			this->m_ops = &Ops<V>();
+			return *value;
+		}
+
+		void reset() noexcept { this->Reset(); }
+		bool has_value() const noexcept { return this->m_ops != nullptr; }
+
+		// type_id<void> when empty, as std::any::type() gives typeid(void)
+		TypeId type() const noexcept { return this->m_ops ? this->m_ops->type : type_id<void>; }
+
+		template <typename T>
+		bool holds() const noexcept { return this->m_ops == &Ops<std::remove_cv_t<T>>(); }
+
+		void swap(BasicAny& other) noexcept { std::swap(*this, other); }
+
+		// the value if it is a T, otherwise null; AnyCast in the words of std::any
+		template <typename T>
+		T* get_if() noexcept
+		{
+			using V = std::remove_cv_t<T>;
+			if (!holds<V>())
+				return nullptr;
+			if constexpr (fits_inline<V>)
+				return std::launder(reinterpret_cast<V*>(this->m_buffer));
+			else
+				return *reinterpret_cast<V**>(this->m_buffer);
+		}
+
+		template <typename T>
+		const T* get_if() const noexcept { return const_cast<BasicAny*>(this)->template get_if<T>(); }
+
+	private:
+
+		// one table per type and storage, comparing its address is the type check
+		template <typename V>
+		static constexpr const DETAIL::AnyOps& Ops() { return DETAIL::AnyOpsFor<V, fits_inline<V>, Copyable>::ops; }
+	};
+
+	template <std::size_t Size = 32>
+	using SmallAny = BasicAny<Size, true>;
+
+	template <std::size_t Size = 32>
+	using UniqueAny = BasicAny<Size, false>;
+
+	// std::any_cast for BasicAny: the pointer forms give null on a wrong type, the others throw std::bad_any_cast
+	template <typename T, std::size_t Size, bool Copyable>
+	T* AnyCast(BasicAny<Size, Copyable>* a) noexcept { return a ? a->template get_if<T>() : nullptr; }
+
+	template <typename T, std::size_t Size, bool Copyable>
+	const T* AnyCast(const BasicAny<Size, Copyable>* a) noexcept { return a ? a->template get_if<T>() : nullptr; }
+
+	template <typename T, std::size_t Size, bool Copyable>
+	T AnyCast(BasicAny<Size, Copyable>& a)
+	{
+		if (auto* p = a.template get_if<std::remove_cv_t<std::remove_reference_t<T>>>())
+			return static_cast<T>(*p);
+		throw std::bad_any_cast();
+	}
+
+	template <typename T, std::size_t Size, bool Copyable>
+	T AnyCast(const BasicAny<Size, Copyable>& a)
+	{
+		if (auto* p = a.template get_if<std::remove_cv_t<std::remove_reference_t<T>>>())
+			return static_cast<T>(*p);
+		throw std::bad_any_cast();
+	}
+
+	template <typename T, std::size_t Size, bool Copyable>
+	T AnyCast(BasicAny<Size, Copyable>&& a)
+	{
+		if (auto* p = a.template get_if<std::remove_cv_t<std::remove_reference_t<T>>>())
+			return static_cast<T>(std::move(*p));
+		throw std::bad_any_cast();
+	}
+}
+
+#endif
@@ -0,0 +1,110 @@
+#pragma once
+
+#ifndef __MODERN_CPP_ARENA_H
+#define __MODERN_CPP_ARENA_H
+
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <memory_resource>
+
+// Request scoped memory for std::pmr: objects that live and die together are bump allocated from
+// one arena and given back all at once, not one delete each.
+// https://en.cppreference.com/w/cpp/memory/monotonic_buffer_resource
+// https://en.cppreference.com/w/cpp/memory/unsynchronized_pool_resource
+//
+//   Arena<> arena;
+//   std::pmr::vector<Cpp11> objects(arena.resource());
+//   objects.emplace_back(1, 2);		// the Cpp11 and everything it allocates come from the arena
+
+namespace MODERNCPP
+{
+	using PmrAllocator = std::pmr::polymorphic_allocator<std::byte>;
+
+	// Monotonic: starts in Bytes of inline buffer, then takes ever larger chunks from upstream.
+	// deallocate does nothing, the memory comes back in release() or the destructor.
+	// One thread at a time, like a request.
+	template <std::size_t Bytes = 16 * 1024>
+	class Arena {
+	public:
+
+		explicit Arena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+			: m_monotonic(m_buffer, Bytes, upstream) {}
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		std::pmr::memory_resource* resource() noexcept { return &m_monotonic; }
+		PmrAllocator allocator() noexcept { return resource(); }
+
+		// everything allocated so far is gone, the inline buffer is used again
+		void release() { m_monotonic.release(); }
+
+	private:
+
+		alignas(std::max_align_t) std::byte m_buffer[Bytes];
+		std::pmr::monotonic_buffer_resource m_monotonic;
+	};
+
+	// An Arena with pools on top: freed blocks are kept by size and handed out again, for requests
+	// that allocate and free a lot along the way. Still one thread at a time.
+	template <std::size_t Bytes = 16 * 1024>
+	class PooledArena {
+	public:
+
+		explicit PooledArena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+			: m_arena(upstream), m_pool(m_arena.resource()) {}
+
+		PooledArena(const PooledArena&) = delete;
+		PooledArena& operator=(const PooledArena&) = delete;
+
+		std::pmr::memory_resource* resource() noexcept { return &m_pool; }
+		PmrAllocator allocator() noexcept { return resource(); }
+
+		void release()
+		{
+			m_pool.release();
+			m_arena.release();
+		}
+
+	private:
+
+		Arena<Bytes> m_arena;
+		std::pmr::unsynchronized_pool_resource m_pool;
+	};
+
+	// unique_ptr deleter that hands the memory back to the resource it came from
+	template <typename T>
+	struct ResourceDelete {
+		std::pmr::memory_resource* resource = nullptr;
+
+		void operator()(T* p) const
+		{
+			p->~T();
+			std::pmr::polymorphic_allocator<T>(resource).deallocate(p, 1);
+		}
+	};
+
+	template <typename T>
+	using ResourcePtr = std::unique_ptr<T, ResourceDelete<T>>;
+
+	// make_unique on a memory resource, T is given the allocator if it takes one (uses-allocator construction)
+	template <typename T, typename... Args>
+	ResourcePtr<T> AllocateUnique(const PmrAllocator& allocator, Args&&... args)
+	{
+		std::pmr::polymorphic_allocator<T> alloc(allocator);
+		T* p = alloc.allocate(1);
+		try
+		{
+			alloc.construct(p, std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			alloc.deallocate(p, 1);
+			throw;
+		}
+		return ResourcePtr<T>(p, ResourceDelete<T>{ alloc.resource() });
+	}
+}
+
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef __MODERN_CPP_CONCAT_H
+#define __MODERN_CPP_CONCAT_H
+
+#include <string>
+#include <cstddef>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+
+// String building in one allocation: every piece is measured first, the result is reserved once and
+// the pieces are written into it, where a + b + c builds and reallocates a temporary per +.
+//
+//   Concat("id=", 42, ',', name);			// "id=42,bob"
+//   Join(", ", "red", std::string("green"), 7);	// "red, green, 7"
+
+namespace MODERNCPP
+{
+	namespace CONCAT
+	{
+		// A view of one argument: strings as they are, a char or an integer (std::to_chars) formatted
+		// into its own buffer. Lives as long as the call that made it, so it is never copied.
+		class Piece {
+		public:
+
+			Piece(std::string_view s) noexcept : m_data(s.data()), m_size(s.size()) {}
+			Piece(char c) noexcept : m_data(m_buffer), m_size(1) { m_buffer[0] = c; }
+
+			template <typename I, typename = std::enable_if_t<std::is_integral<I>::value
+				&& !std::is_same<I, char>::value && !std::is_same<I, bool>::value>>
+			Piece(I value) noexcept : m_data(m_buffer)
+			{
+				m_size = static_cast<std::size_t>(std::to_chars(m_buffer, m_buffer + sizeof(m_buffer), value).ptr - m_buffer);
+			}
+
+			Piece(const Piece&) = delete;
+			Piece& operator=(const Piece&) = delete;
+
+			std::size_t size() const noexcept { return m_size; }
+			std::string_view view() const noexcept { return { m_data, m_size }; }
+
+		private:
+
+			const char* m_data;
+			std::size_t m_size;
+			char m_buffer[20];		// -9223372036854775808, 18446744073709551615
+		};
+
+		template <typename... Pieces>
+		std::string Join(std::string_view separator, const Pieces&... pieces)
+		{
+			constexpr std::size_t count = sizeof...(Pieces);
+			std::string s;
+			s.reserve((pieces.size() + ... + 0) + (count > 1 ? separator.size() * (count - 1) : 0));
+			if constexpr (count > 0)
+			{
+				std::size_t i = 0;
+				((i++ ? s.append(separator).append(pieces.view()) : s.append(pieces.view())), ...);
+			}
+			return s;
+		}
+	}
+
+	// strings, string_views, C strings, chars and integers, one after another
+	template <typename... Args>
+	std::string Concat(const Args&... args)
+	{
+		return CONCAT::Join(std::string_view(), CONCAT::Piece(args)...);
+	}
+
+	// the same with separator between each two of them
+	template <typename... Args>
+	std::string Join(std::string_view separator, const Args&... args)
+	{
+		return CONCAT::Join(separator, CONCAT::Piece(args)...);
+	}
+}
+
+#endif
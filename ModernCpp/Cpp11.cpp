@@ -1,8 +1,16 @@
 #include "pch.h"
 #include "Cpp11.h"
-
-#include <mutex>
-#include <queue>
+#include "Arena.h"
+#include "Concat.h"
+#include "Dispatch.h"
+#include "Log.h"
+#include "Random.h"
+#include "Regex.h"
+#include "RingBuffer.h"
+#include "TextScan.h"
+#include "ThreadPool.h"
+
+#include <atomic>
 #include <regex>
 #include <string>
 #include <random>
@@ -12,31 +20,95 @@
 #include <algorithm>
 #include <functional>
 
+// C++11, the one explicit instantiation the extern template in Cpp11.h refers to
+template class std::vector<std::string>;
+
 namespace MODERNCPP
 {
-	// Simple move constructor
-	Cpp11::Cpp11(Cpp11&& arg) : member(std::move(arg.member)) // the expression "arg.member" is lvalue
+	// Move constructor, member by member in declaration order: a member left out would be
+	// default initialized instead (sp would allocate a new Base on every move)
+	Cpp11::Cpp11(Cpp11&& arg) noexcept :
+		Base(std::move(arg)),
+		x(arg.x), y(arg.y),
+		member(std::move(arg.member)), // the expression "arg.member" is lvalue
+		count(std::exchange(arg.count, 0)),
+		m_vMap(std::move(arg.m_vMap)),
+		u(std::move(arg.u)),
+		sp(std::move(arg.sp)),
+		wp(std::move(arg.wp)),
+		up(std::move(arg.up))
 	{}
 
-	// Simple move assignment operator
+	// Allocator-extended move: on the same resource it steals like the move above, on another one
+	// the vector, the map and the shared Base are copied over
+	Cpp11::Cpp11(std::allocator_arg_t, const allocator_type& alloc, Cpp11&& arg) :
+		Base(std::allocator_arg, alloc, arg),
+		x(arg.x), y(arg.y),
+		member(std::move(arg.member)),
+		count(std::exchange(arg.count, 0)),
+		m_vMap(std::move(arg.m_vMap), alloc),
+		u(std::move(arg.u), alloc),
+		sp(std::move(arg.sp)),
+		wp(std::move(arg.wp)),
+		up(std::move(arg.up))
+	{
+		OwnShared(arg.get_allocator());
+	}
+
+	// Move assignment operator, keeps this object's resource: from another resource the
+	// elements are copied over, which allocates, so it is not noexcept (as std::pmr containers)
 	Cpp11& Cpp11::operator=(Cpp11&& arg)
 	{
 		if (this != &arg)
+		{
+			Base::operator=(std::move(arg));
+			x = arg.x;
+			y = arg.y;
 			member = std::move(arg.member);
+			count = std::exchange(arg.count, 0);
+			m_vMap = std::move(arg.m_vMap);
+			u = std::move(arg.u);
+			sp = std::move(arg.sp);
+			wp = std::move(arg.wp);
+			up = std::move(arg.up);
+			OwnShared(arg.get_allocator());
+		}
 
 		return *this;
 	}
 
+	// a shared Base moved in from another resource would dangle once that one is released
+	void Cpp11::OwnShared(const allocator_type& source)
+	{
+		if (!sp || source == get_allocator())
+			return;
+		const bool watched = wp.lock() == sp;
+		sp = std::allocate_shared<Base>(get_allocator(), *sp);
+		if (watched)
+			wp = sp;
+	}
+
+	// growth only move constructs, the assignment is free to allocate
+	static_assert(std::is_nothrow_move_constructible<Cpp11>::value,
+		"Cpp11 must move without throwing, or std::vector falls back to its copy");
+
 	Cpp11::Cpp11(const std::initializer_list<int> &list) : // initialized via list initialization
 		Cpp11(0, 1)			// possibly call delegating constructor
 	{
-		for (const auto &i : list)
-			m_vMap[count++] = i;
+		*this = list;
+	}
+
+	Cpp11::Cpp11(std::allocator_arg_t, const allocator_type& alloc, const std::initializer_list<int> &list) :
+		Cpp11(std::allocator_arg, alloc, 0, 1)
+	{
+		*this = list;
 	}
 
 	Cpp11& Cpp11::operator=(const std::initializer_list<int> &list)
 	{
 		count = 0;
+		if (list.size() > m_vMap.size())
+			m_vMap.resize(list.size());		// grow first, never write past the end
 		for (const auto &i : list)
 			m_vMap[count++] = i;
 
@@ -51,7 +123,7 @@ namespace MODERNCPP
 
 	void Cpp11::DoWork(void* pObj)
 	{
-		std::cout << "DoWork";
+		Log() << "DoWork";
 
 		Cpp11* p = static_cast<Cpp11*>(pObj);
 		if (p)
@@ -62,35 +134,35 @@ namespace MODERNCPP
 
 	void Cpp11::DoWorkInternal()
 	{
-		std::cout << "DoWorkInternal";
+		Log() << "DoWorkInternal";
 		std::this_thread::sleep_for(std::chrono::seconds(1));
 	}
 
-	std::thread Cpp11::DoWorkAsync(int n)
+	std::future<void> Cpp11::DoWorkAsync(int n)
 	{
-		return std::thread([=] { DoWorkInternal(); });
+		return ThreadPool::Instance().submit([=] { DoWorkInternal(); });
 	}
 
 	void Cpp11::ForEachLoop()
 	{
 		// old way
-		for (std::vector<int>::iterator i = m_vMap.begin(); i != m_vMap.end(); i++)
-			std::cout << *i;
+		for (Map::iterator i = m_vMap.begin(); i != m_vMap.end(); i++)
+			Log() << *i;
 
 		// auto
 		for (auto i = m_vMap.begin(); i != m_vMap.end(); i++)
-			std::cout << *i;
+			Log() << *i;
 
 		// auto foreach usinig reference (no copy)
 		for (const auto &i : m_vMap) 
-			std::cout << i;
+			Log() << i;
 
 		// foreach lambda
 		std::for_each(std::begin(m_vMap), std::end(m_vMap), [](auto i) {
-			std::cout << i;
+			Log() << i;
 		});
 
-		std::cout << std::endl;
+		Log() << '\n';
 	}
 
 	long Cpp11::EnumClass(WeekDay day)
@@ -129,7 +201,7 @@ namespace MODERNCPP
 			};
 		};
 
-		auto p = vglambda([](auto v1, auto v2, auto v3) { std::cout << v1 << v2 << v3; });
+		auto p = vglambda([](auto v1, auto v2, auto v3) { Log() << v1 << v2 << v3; });
 		auto q = p(1, 'a', 3.14); // outputs 1a3.14
 		q();                      // outputs 1a3.14
 
@@ -139,7 +211,7 @@ namespace MODERNCPP
 			return operator()(this->x + y); // X::operator()(this->x + (*this).y)
 											// this has type X*
 		};
-		std::cout << std::endl;
+		Log() << '\n';
 	}
 
 	void Cpp11::StaticAssert()
@@ -165,34 +237,31 @@ namespace MODERNCPP
 	{
 		//normal_distribution									// bell curve normal dist
 		uniform_int_distribution<int> num_range{ min, max };	// distribution that maps to the ints min..max
-		default_random_engine re {};							// the default engine
+		thread_local default_random_engine re {};				// the default engine, default seeded once per thread
 
-		//std::cout << num_range(re);				// x becomes a value in [1:6]
+		auto d = num_range(re);						// roll the dice: x becomes a value in [1:6]
 
-		auto dice{ std::bind(num_range,re) };		// make a generator
-		auto d = dice();							// roll the dice: x becomes a value in [1:6]
-
-		std::cout << d << endl;
+		Log() << d << '\n';
 		return d;
 	}
 
 	long Cpp11::RandomNumberGenerator(int min, int max)
 	{
-		std::random_device rd;		//Will be used to obtain a seed for the random number engine
-		std::mt19937 gen(rd());		//Standard mersenne_twister_engine seeded with rd()
+		std::mt19937& gen = ThreadLocalEngine<std::mt19937>();	//Standard mersenne_twister_engine, seeded once per thread
 		std::uniform_int_distribution<> dis(min, max);
 
 		auto g = dis(gen);
-		std::cout << g << endl;
+		Log() << g << '\n';
 		return g;
 	}
 
 	void Cpp11::UniquePtr()
 	{
-		std::unique_ptr<Cpp11> up(new Cpp11);
+		// on this object's memory resource, the deleter gives the memory back to it
+		ResourcePtr<Cpp11> up = AllocateUnique<Cpp11>(get_allocator());
 
 		if (up && up->BaseMethod())		// use implicit cast to bool to ensure res contains a Resource
-			std::cout << *up;
+			Log() << *up;
 	}
 
 	std::tuple<int, double> Cpp11::ReturnTuple()	// return a tuple that contains an int and a double
@@ -204,14 +273,14 @@ namespace MODERNCPP
 	{
 		// tuple
 		std::tuple<int, double> s = ReturnTuple();	// get our tuple
-		std::cout << std::get<0>(s) << ' '
+		Log() << std::get<0>(s) << ' '
 				  << std::get<1>(s) << '\n';		// use std::get<n> to get the nth element of the tuple
 
 		// tie to tuple
 		int a;
 		double b;
 		std::tie(a, b) = ReturnTuple();		// put elements of tuple in variables a and b
-		std::cout << a << ' ' << b << '\n';
+		Log() << a << ' ' << b << '\n';
 	}
 
 	void Cpp11::ReferenceWrapper()
@@ -226,29 +295,38 @@ namespace MODERNCPP
 
 		// Print out all of the elements in our vector, use .get() to get our element from the wrapper
 		for (const auto& i : v)
-			std::cout << "Class = " << i.get().getName() << " Value = " << i.get().getValue() << "\n";
+			Log() << "Class = " << i.get().getName() << " Value = " << i.get().getValue() << "\n";
+
+		// the same as values of a closed set of classes, an array per class, without the vtable (Dispatch.h)
+		BaseVector s;
+		s.emplace_back<Base>().setValue(5);
+		s.emplace_back<Cpp11>().setValue(6);
+
+		for (std::size_t i = 0; i < s.size(); ++i)
+			Log() << "Class = " << GetName(s, i) << " Value = " << GetValue(s, i) << "\n";
 	}
 
 	void Cpp11::InitializerList()
 	{
 		Cpp11 array{ 5, 4, 3, 2, 1 }; // initializer list
 		for (int count = 0; count < array.getLength(); ++count)
-			std::cout << array[count] << ' ';
+			Log() << array[count] << ' ';
 
 		array = { 1, 3, 5, 7, 9, 11 };		// calls assignment = init list
 
 		for (int count = 0; count < array.getLength(); ++count)
-			std::cout << array[count] << ' ';
+			Log() << array[count] << ' ';
 
-		std::cout << std::endl;
+		Log() << '\n';
 	}
 
 	void Cpp11::VariadicTemplate()
 	{
 		long sum = adder(1, 2, 3, 8, 7);
 		std::string s1 = "x", s2 = "aa", s3 = "bb", s4 = "yy";
-		std::string ssum = adder(s1, s2, s3, s4);		
-		std::cout << s1 << ssum << endl;
+		std::string ssum = Concat(s1, s2, s3, s4);		// not adder(): sized first, allocated once
+		Log() << s1 << ssum << '\n';
+		Log() << Join(" + ", 1, 2, 3, 8, 7) << " = " << sum << '\n';
 	}
 
 	void Cpp11::UnorderedContainers()
@@ -258,18 +336,31 @@ namespace MODERNCPP
 		//unordered_multimap
 		//unordered_multiset
 
-		// Iterate and print keys and values of unordered_map
+		// Iterate and print keys and values, the fixed colors unless changed, then the ones on top
+		for (const auto& n : base_colors) {
+			if (!u.contains(n.first))
+				Log() << "Key:[" << n.first << "] Value:[" << n.second << "]\n";
+		}
 		for (const auto& n : u) {
-			std::cout << "Key:[" << n.first << "] Value:[" << n.second << "]\n";
+			Log() << "Key:[" << n.first << "] Value:[" << n.second << "]\n";
 		}
 
 		// Add two new entries to the unordered_map
 		u["BLACK"] = "#000000";
 		u["WHITE"] = "#FFFFFF";
 
-		// Output values by key
-		std::cout << "The HEX of color RED is:[" << u["RED"] << "]\n";
-		std::cout << "The HEX of color BLACK is:[" << u["BLACK"] << "]\n";
+		// Output values by key, the literals are hashed and compared as they are, no temporary std::string
+		Log() << "The HEX of color RED is:[" << Color("RED") << "]\n";
+		Log() << "The HEX of color BLACK is:[" << Color("BLACK") << "]\n";
+	}
+
+	std::string_view Cpp11::Color(std::string_view name) const
+	{
+		const auto i = u.find(name);
+		if (i != u.end())
+			return i->second;
+		const auto* base = base_colors.find(name);
+		return base ? base->second : std::string_view();
 	}
 
 	void Cpp11::RegularExpression()
@@ -278,34 +369,39 @@ namespace MODERNCPP
 			"\"I know, I'll use regular expressions.\" "
 			"Now they have two problems.";
 
-		std::regex self_regex("REGULAR EXPRESSIONS",
+		// compiled once per process, matched by the DFA instead of std::regex's backtracking
+		RegexCache& cache = RegexCache::Instance();
+
+		const DfaRegex& self_regex = cache.Dfa("REGULAR EXPRESSIONS",
 			std::regex_constants::ECMAScript | std::regex_constants::icase);
-		if (std::regex_search(s, self_regex)) {
-			std::cout << "Text contains the phrase 'regular expressions'\n";
-		}
 
-		std::regex word_regex("(\\S+)");
-		auto words_begin =
-			std::sregex_iterator(s.begin(), s.end(), word_regex);
-		auto words_end = std::sregex_iterator();
+		// one pass for the phrase, the words and the long words, in parallel line aligned chunks
+		// once the text is larger than a chunk (a MappedFile scans the same way without reading it)
+		const int N = 6;
+		const TextStats stats = ScanText(s, self_regex, N);
+		if (stats.matches) {
+			Log() << "Text contains the phrase 'regular expressions'\n";
+		}
 
-		std::cout << "Found "
-			<< std::distance(words_begin, words_end)
+		// the words "(\\S+)" would match, split on a SIMD whitespace mask
+		Log() << "Found "
+			<< stats.words
 			<< " words\n";
 
-		const int N = 6;
-		std::cout << "Words longer than " << N << " characters:\n";
-		for (std::sregex_iterator i = words_begin; i != words_end; ++i) {
-			std::smatch match = *i;
-			std::string match_str = match.str();
-			if (match_str.size() > N) {
-				std::cout << "  " << match_str << '\n';
-			}
+		Log() << "Words longer than " << N << " characters:\n";
+		for (std::string_view match_str : stats.longWords) {
+			Log() << "  " << match_str << '\n';
 		}
 
-		std::regex long_word_regex("(\\w{7,})");
-		std::string new_s = std::regex_replace(s, long_word_regex, "[$&]");
-		std::cout << new_s << '\n';
+		// replaced as the text streams by in 16 byte pieces, a word cut between pieces is carried over
+		// and the output goes straight into the log line, no whole result string is built
+		LogLine line;
+		RegexReplaceStream long_words("(\\w{7,})", "[$&]", [&line](std::string_view out) { line << out; });
+		for (std::size_t pos = 0; pos < s.size(); pos += 16) {
+			long_words.write(std::string_view(s).substr(pos, 16));
+		}
+		long_words.finish();
+		line << '\n';
 	}
 
 	void Cpp11::ParallelThreads()
@@ -315,108 +411,145 @@ namespace MODERNCPP
 		// Serial version
 		{
 			// Pre loop
-			std::cout << "serial:" << std::endl;
+			Log() << "serial:" << '\n';
 			// loop over all items
 			for (int i = 0; i < nloop; i++)
 			{
 				// inner loop
 				{
 					const int j = i * i;
-					std::cout << j << std::endl;
+					Log() << j << '\n';
 				}
 			}
 			// Post loop
-			std::cout << std::endl;
+			Log() << '\n';
 		}
 
 		// Parallel version
-		// number of threads
-		const size_t nthreads = std::thread::hardware_concurrency();
+		// chunks run on the persistent work-stealing pool, no threads are created per call
+		ThreadPool& pool = ThreadPool::Instance();
 		{
 			// Pre loop
-			std::cout << "parallel (" << nthreads << " threads):" << std::endl;
-			std::vector<std::thread> threads(nthreads);
-			std::mutex critical;
-			for (int t = 0; t < nthreads; t++)
+			Log() << "parallel (" << pool.size() << " threads):" << '\n';
+			pool.parallel_for(0, nloop, [&](const size_t bi, const size_t ei)
 			{
-				threads[t] = std::thread(std::bind(
-					[&](const int bi, const int ei, const int t)
+				// loop over the chunk, format privately
+				std::string out;
+				for (size_t i = bi; i < ei; i++)
 				{
-					// loop over all items
-					for (int i = bi; i < ei; i++)
-					{
-						// inner loop
-						{
-							const int j = i * i;
-							// (optional) make output critical
-							std::lock_guard<std::mutex> lock(critical);
-							std::cout << j << std::endl;
-						}
-					}
-				}, t*nloop / nthreads, (t + 1) == nthreads ? nloop : (t + 1)*nloop / nthreads, t));
-			}
-			std::for_each(threads.begin(), threads.end(), [](std::thread& x) {x.join(); });
+					// inner loop
+					const size_t j = i * i;
+					out += std::to_string(j);
+					out += '\n';
+				}
+				// one record per chunk, the log sink keeps records whole, no lock needed
+				Log() << out;
+			});
 			// Post loop
-			std::cout << std::endl;
+			Log() << '\n';
 		}
 	}
 
 	void Cpp11::ProducerConsumer()
 	{
-		int c = 0;
-		bool done = false;
-		std::queue<int> goods;
+		// single producer -> single consumer, the counters are thread private and
+		// only the ring buffer indices are shared (acquire/release, no locks)
+		{
+			const int nitems = 500;
+			std::atomic<bool> done{ false };
+			SpscRingBuffer<int> goods(64);
+			int produced = 0, consumed = 0;
+
+			thread producer([&]() {
+				for (int i = 0; i < nitems; ++i) {
+					while (!goods.try_push(i))
+						std::this_thread::yield();	// full, let the consumer catch up
+					produced++;
+				}
+				done.store(true, std::memory_order_release);
+			});
+
+			thread consumer([&]() {
+				int batch[16];
+				for (;;) {
+					const bool finished = done.load(std::memory_order_acquire);
+					const size_t n = goods.pop_bulk(batch, 16);
+					consumed += static_cast<int>(n);
+					if (n == 0) {
+						if (finished)
+							break;			// producer is gone and the buffer is drained
+						std::this_thread::yield();
+					}
+				}
+			});
 
-		thread producer([&]() {
-			for (int i = 0; i < 500; ++i) {
-				goods.push(i);
-				c++;
-			}
-			done = true;
-		});
+			producer.join();
+			consumer.join();
+			Log() << "Net: " << produced - consumed << '\n';
+		}
 
-		thread consumer([&]() {
-			while (!done) {
-				while (!goods.empty()) {
-					goods.pop();
-					c--;
-				}
-			}
-		});
+		// many producers -> many consumers
+		{
+			const int nitems = 500, nproducers = 2, nconsumers = 2;
+			MpmcRingBuffer<int> goods(64);
+			std::atomic<int> c{ 0 };
+			std::atomic<int> remaining{ nitems * nproducers };
+
+			std::vector<thread> threads;
+			for (int p = 0; p < nproducers; ++p)
+				threads.emplace_back([&]() {
+					for (int i = 0; i < nitems; ++i) {
+						while (!goods.try_push(i))
+							std::this_thread::yield();
+						c.fetch_add(1, std::memory_order_relaxed);
+					}
+				});
+			for (int t = 0; t < nconsumers; ++t)
+				threads.emplace_back([&]() {
+					int v;
+					while (remaining.load(std::memory_order_relaxed) > 0) {
+						if (goods.try_pop(v)) {
+							c.fetch_sub(1, std::memory_order_relaxed);
+							remaining.fetch_sub(1, std::memory_order_relaxed);
+						}
+						else
+							std::this_thread::yield();
+					}
+				});
 
-		producer.join();
-		consumer.join();
-		cout << "Net: " << c << endl;
+			std::for_each(threads.begin(), threads.end(), [](thread& x) { x.join(); });
+			Log() << "Net: " << c << '\n';
+		}
 	}
 
 	void Cpp11::DetachedThread()
 	{
 		unsigned int n = std::thread::hardware_concurrency();
 
-		std::cout << "Starting thread caller.\n";
-		std::cout << n << " concurrent threads are supported.\n";
+		Log() << "Starting thread caller.\n";
+		Log() << n << " concurrent threads are supported.\n";
 
-		std::thread t([this] { this->DoWorkInternal(); });
-		t.detach();
+		// fire and forget on the pool, instead of a detached thread that outlives its owner
+		ThreadPool::Instance().post([this] { this->DoWorkInternal(); });
 
 		std::this_thread::sleep_for(std::chrono::seconds(2));
-		std::cout << "Exiting thread caller.\n";
+		Log() << "Exiting thread caller.\n";
 	}
 
 	void Cpp11::VariableSizes()
 	{
-		std::cout << "bool:\t\t" << sizeof(bool) << " bytes" << std::endl;
-		std::cout << "char:\t\t" << sizeof(char) << " bytes" << std::endl;
-		std::cout << "wchar_t:\t" << sizeof(wchar_t) << " bytes" << std::endl;
-		std::cout << "char16_t:\t" << sizeof(char16_t) << " bytes" << std::endl; // C++11, may not be supported by your compiler
-		std::cout << "char32_t:\t" << sizeof(char32_t) << " bytes" << std::endl; // C++11, may not be supported by your compiler
-		std::cout << "short:\t\t" << sizeof(short) << " bytes" << std::endl;
-		std::cout << "int:\t\t" << sizeof(int) << " bytes" << std::endl;
-		std::cout << "long:\t\t" << sizeof(long) << " bytes" << std::endl;
-		std::cout << "long long:\t" << sizeof(long long) << " bytes" << std::endl; // C++11, may not be supported by your compiler
-		std::cout << "float:\t\t" << sizeof(float) << " bytes" << std::endl;
-		std::cout << "double:\t\t" << sizeof(double) << " bytes" << std::endl;
-		std::cout << "long double:\t" << sizeof(long double) << " bytes" << std::endl;
+		Log() << "bool:\t\t" << sizeof(bool) << " bytes" << '\n';
+		Log() << "char:\t\t" << sizeof(char) << " bytes" << '\n';
+		Log() << "wchar_t:\t" << sizeof(wchar_t) << " bytes" << '\n';
+		Log() << "char16_t:\t" << sizeof(char16_t) << " bytes" << '\n'; // C++11, may not be supported by your compiler
+		Log() << "char32_t:\t" << sizeof(char32_t) << " bytes" << '\n'; // C++11, may not be supported by your compiler
+		Log() << "short:\t\t" << sizeof(short) << " bytes" << '\n';
+		Log() << "int:\t\t" << sizeof(int) << " bytes" << '\n';
+		Log() << "long:\t\t" << sizeof(long) << " bytes" << '\n';
+		Log() << "long long:\t" << sizeof(long long) << " bytes" << '\n'; // C++11, may not be supported by your compiler
+		Log() << "float:\t\t" << sizeof(float) << " bytes" << '\n';
+		Log() << "double:\t\t" << sizeof(double) << " bytes" << '\n';
+		Log() << "long double:\t" << sizeof(long double) << " bytes" << '\n';
 	}
 
 	auto Cpp11::TrailingReturnType() const -> int
@@ -430,20 +563,20 @@ namespace MODERNCPP
 		auto x = 4;
 		auto y = 3.37;
 		auto ptr = &x;
-		std::cout << typeid(x).name() << endl
-				  << typeid(y).name() << endl
-				  << typeid(ptr).name() << endl;
+		Log() << typeid(x).name() << '\n'
+				  << typeid(y).name() << '\n'
+				  << typeid(ptr).name() << '\n';
 
 		//int x = 5;
 		// j will be of type int : data type of x 
 		decltype(x) j = x + 5;
-		std::cout << typeid(j).name();
+		Log() << typeid(j).name();
 
 		// This call returns 3.44 of doubale type 
-		std::cout << findMin(4, 3.44) << endl;
+		Log() << findMin(4, 3.44) << '\n';
 
 		// This call returns 3 of int type 
-		std::cout << findMin(5.4, 3) << endl;
+		Log() << findMin(5.4, 3) << '\n';
 	}
 
 	std::ostream& operator<<(std::ostream& out, const Cpp11 &res)
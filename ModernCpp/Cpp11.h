@@ -3,9 +3,18 @@
 #ifndef __MODERN_CPP_11_H
 #define __MODERN_CPP_11_H
 
+#include "Expected.h"
+#include "FlatHashMap.h"
+#include "PerfectHash.h"
+#include "SmallVector.h"
+
 #include <thread>
+#include <future>
+#include <memory>
+#include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory_resource>
 #include <initializer_list>
 
 // global macros
@@ -18,11 +27,12 @@ using namespace std;
 
 // https://www.learncpp.com/cpp-tutorial/b-1-introduction-to-c11/
 
+// C++11, tells the compiler not to instantiate the template in this translation unit.
+// (must be declared in a namespace enclosing std, i.e. the global one)
+extern template class std::vector<std::string>;
+
 namespace MODERNCPP
 {
-	// C++11, tells the compiler not to instantiate the template in this translation unit.
-	extern template class std::vector<std::string>;
-
 	// for enum casting
 	enum class WeekDay { Sunday, Monday, Tuesday, Wednesday, Thursday, Friday, Saturday };
 
@@ -54,7 +64,7 @@ namespace MODERNCPP
 			"Data Structure requires default-constructible elements");
 	};
 
-	// Variadic template
+	// Variadic template, one call per argument; for strings Concat (Concat.h) allocates once
 	template<typename T>
 	T adder(T v) { return v; }
 
@@ -91,7 +101,25 @@ namespace MODERNCPP
 	class Base {
 	public:
 
+		// std::pmr: an object allocates from the memory resource it was constructed with, the
+		// default one unless it is given another. Derived classes take it as (std::allocator_arg, alloc, ...),
+		// so std::pmr containers and allocate_shared hand theirs on (uses-allocator construction).
+		using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+		Base() = default;
+		explicit Base(const allocator_type& alloc) noexcept : m_resource(alloc.resource()) {}
+		Base(std::allocator_arg_t, const allocator_type& alloc, const Base& other) noexcept : m_value(other.m_value), m_resource(alloc.resource()) {}
+
+		// a user-declared destructor suppresses the implicit moves, bring them back; as std::pmr
+		// containers do, a copy starts on the default resource, a move keeps the source's and
+		// assignment never changes it
+		Base(const Base& other) noexcept : m_value(other.m_value) {}
+		Base(Base&& other) noexcept : m_value(other.m_value), m_resource(other.m_resource) {}
+		Base& operator=(const Base& other) noexcept { m_value = other.m_value; return *this; }
+		Base& operator=(Base&& other) noexcept { m_value = other.m_value; return *this; }
 		virtual ~Base() noexcept {}					// C++11, compile-time check make sure no throw
+
+		allocator_type get_allocator() const noexcept { return m_resource; }
 		virtual bool BaseMethod() { return false; }
 		virtual void BaseMethod(int n) final {}		// not overridable at sub-classes
 
@@ -101,19 +129,28 @@ namespace MODERNCPP
 
 	public:
 		int m_value{ 0 };
+
+	private:
+		std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
 	};
 
 	class Cpp11 : public Base {
 	public:
 
 		explicit Cpp11() noexcept {}			// cannot called implicitly
-		Cpp11(Cpp11&&);							// MovableClass, typical declaration of a move constructor.
-		Cpp11& operator=(Cpp11&& c);			// MovableClass operator =
+		Cpp11(Cpp11&&) noexcept;				// MovableClass, typical declaration of a move constructor.
+		Cpp11& operator=(Cpp11&& c);			// MovableClass operator =, copies from another resource so it may throw
 		//Cpp11&& operator=(Cpp11&&) = default;	// Forcing a move constructor to be generated by the compiler.
 		//Cpp11&& operator=(Cpp11&&) = delete;	// Avoiding implicit move constructor.			
 		Cpp11(int id) : Cpp11(id, 1) {}			// Use a delegating constructors to minimize redundant code
 		Cpp11(int id1, int id2 = 0) : count(0), member(id2) {}
 		Cpp11(const std::initializer_list<int> &);				// using initializer list
+
+		// the same on a memory resource, its vector, map and shared Base allocate from alloc
+		explicit Cpp11(std::allocator_arg_t, const allocator_type& alloc) : Base(alloc) {}
+		Cpp11(std::allocator_arg_t, const allocator_type& alloc, int /*id1*/, int id2 = 0) : Base(alloc), member(id2), count(0) {}
+		Cpp11(std::allocator_arg_t, const allocator_type& alloc, const std::initializer_list<int> &);
+		Cpp11(std::allocator_arg_t, const allocator_type& alloc, Cpp11&&);		// what std::pmr::vector moves with
 		Cpp11& operator=(const std::initializer_list<int> &);	// inializer list assignment made possible
 
 		int& operator[](int);					// overload [] for array access
@@ -130,7 +167,7 @@ namespace MODERNCPP
 
 		// LAMBDAs
 		// https://en.cppreference.com/w/cpp/language/lambda
-		int x, y;
+		int x{}, y{};
 		int operator()(int);
 		void Lambda();
 
@@ -153,7 +190,7 @@ namespace MODERNCPP
 		// https://thispointer.com/c-11-multithreading-part-1-three-different-ways-to-create-threads/
 		static void DoWork(void*);
 		void DoWorkInternal();
-		std::thread DoWorkAsync(int);
+		std::future<void> DoWorkAsync(int);
 		void ParallelThreads();
 		void ProducerConsumer();
 		void DetachedThread();
@@ -161,33 +198,54 @@ namespace MODERNCPP
 		// Indicates that the function does not return.
 		[[noreturn]] void NoReturn() { throw "error"; }		// OK
 
+		// the same failure returned instead of thrown, nothing to unwind and nothing to catch
+		Expected<void, const char*> NoReturnExpected() const { return Unexpected("error"); }
+
 		// friend
 		friend std::ostream& operator<<(std::ostream&, const Cpp11&);
+		// exact match for ADL, preferred to both std::swap and the copying MODERNCPP::swap template above
+		// not noexcept: the move assignment copies when the resources differ, and that can throw
+		friend void swap(Cpp11& a, Cpp11& b)
+		{
+			Cpp11 t(std::move(a));
+			a = std::move(b);
+			b = std::move(t);
+		}
 
 	private:
 
 		// tuple
 		std::tuple<int, double> ReturnTuple();
 
+		// u first, then base_colors, empty if neither has it
+		std::string_view Color(std::string_view name) const;
+
+		// sp on this object's resource after a move from source's
+		void OwnShared(const allocator_type& source);
+
 	private:
 
 		// initialize
 		int member = 0;
 		int count{};		// uniform initialization, default initialization to 0
-		std::vector<int> m_vMap = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		using Map = PMR::SmallVector<int, 16>;		// up to 16 values inside the object, no allocation
+		Map m_vMap{ { 1, 2, 3, 4, 5, 6, 7, 8, 9 }, get_allocator() };
 
-		// Create an unordered_map of three strings (that map to strings)
-		std::unordered_map<std::string, std::string> u = {
+		// The three fixed colors, a perfect hash table built by the compiler and shared by all instances
+		static constexpr auto base_colors = MakePerfectHashMap<std::string_view, std::string_view>({
 			{"RED","#FF0000"},
 			{"GREEN","#00FF00"},
 			{"BLUE","#0000FF"}
-		};
+		});
+
+		// Colors added or changed at runtime, on top of base_colors, flat, looked up by string_view
+		PMR::FlatHashMap<std::pmr::string, std::pmr::string> u{ get_allocator() };
 
 		// smart pointers
 		// https://www.codeproject.com/Articles/541067/Cplusplus-Smart-Pointers
 
 		//std::auto_ptr<Base> ap;								// C++98, deprecated in C++17
-		std::shared_ptr<Base> sp = std::make_shared<Base>();	// C++11, released until all shared pointer out of scope
+		std::shared_ptr<Base> sp = std::allocate_shared<Base>(get_allocator());	// C++11, released until all shared pointer out of scope
 		std::weak_ptr<Base> wp = sp;							// C++11, shared pointer, resolve cyclic reference
 		std::unique_ptr<Base> up;								// C++11, replacement for auto pointer, 1 reference
 	};
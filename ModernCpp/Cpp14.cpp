@@ -1,7 +1,13 @@
 #include "pch.h"
 #include "Cpp14.h"
+#include "Log.h"
+#include "Transparent.h"
 
+#include <chrono>
 #include <string>
+#include <vector>
+#include <cassert>
+#include <iomanip>
 #include <iostream>
 #include <algorithm>
 
@@ -9,7 +15,7 @@ namespace MODERNCPP
 {
 	void Cpp14::AggregateMemberInitialization()
 	{
-		std::cout << x.length << " " << x.width << endl;
+		Log() << x.length << " " << x.width << '\n';
 	}
 
 	void Cpp14::BinaryLiterals()
@@ -27,7 +33,7 @@ namespace MODERNCPP
 		bin = 0xFF;		// assign binary 1111 1111 to the variable
 		bin = 0xB3;		// assign binary 1011 0011 to the variable
 		bin = 0xF770;	// assign binary 1111 0111 0111 0000 to the variable
-		std::cout << bin << endl;
+		Log() << bin << '\n';
 
 		// C++14
 		// In C++14, we can assign binary literals by using the 0b prefix:
@@ -36,26 +42,26 @@ namespace MODERNCPP
 		bin = 0b11;						// assign binary 0000 0011 to the variable
 		bin = 0b1010;					// assign binary 0000 1010 to the variable
 		bin = 0b11110000;				// assign binary 1111 0000 to the variable
-		std::cout << bin << endl;
+		Log() << bin << '\n';
 
 		bin = 0b1011'0010;				// assign binary 1011 0010 to the variable
 		long value = 2'132'673'462;		// much easier to read than 2132673462
-		std::cout << bin << endl;
+		Log() << bin << '\n';
 	}
 
 	void Cpp14::DigitSeparators()
 	{
 		auto integer_literal = 1'000'000;
-		std::cout << integer_literal << endl;
+		Log() << integer_literal << '\n';
 
 		auto floating_point_literal = 0.000'015'3;
-		std::cout << floating_point_literal << endl;
+		Log() << floating_point_literal << '\n';
 
 		auto binary_literal = 0b0100'1100'0110;
-		std::cout << binary_literal << endl;
+		Log() << binary_literal << '\n';
 
 		auto silly_example = 1'0'0'000'00;
-		std::cout << silly_example << endl;
+		Log() << silly_example << '\n';
 	}
 
 	void Cpp14::GenericLambdaExpr()
@@ -74,19 +80,19 @@ namespace MODERNCPP
 			}
 		} L;
 		*/
-		std::cout << typeid(L).name() << endl;
+		Log() << typeid(L).name() << '\n';
 	}
 
 	void Cpp14::LambdaCaptureExpr()
 	{
 		// use of an initializer expression:
 		auto lambda1 = [value = 1]{ return value; };
-		std::cout << lambda1() << endl;
+		Log() << lambda1() << '\n';
 
 		// capture by move, via the use of the standard std::move function
 		std::unique_ptr<int> ptr(new int(10));
 		auto lambda2 = [value = std::move(ptr)]{ return *value; };
-		std::cout << lambda2() << endl;
+		Log() << lambda2() << '\n';
 	}
 
 	void Cpp14::ConstantExprRestriction()
@@ -103,13 +109,13 @@ namespace MODERNCPP
 	void Cpp14::VariableTemplate()
 	{
 		auto x = pi<double>;		// can be int, double, float, etc
-		std::cout << x << endl;
+		Log() << x << '\n';
 
 		auto y = pi<const char*>;	// can be int, double, float, etc
-		std::cout << y << endl;
+		Log() << y << '\n';
 
 		auto z = circular_area<double>(3.0);	// can be int, double, float, etc
-		std::cout << z << endl;		
+		Log() << z << '\n';		
 	}
 
 	void Cpp14::TupleAddressingByType()
@@ -120,7 +126,7 @@ namespace MODERNCPP
 		//string s = get<string>(t);  // Compile-time error due to ambiguity
 		string s = get<0>(t);
 
-		std::cout << i << j << s << endl;
+		Log() << i << j << s << '\n';
 	}
 
 	void Cpp14::MakeUnique()
@@ -129,12 +135,12 @@ namespace MODERNCPP
 
 		// Create a single dynamically allocated Fraction with numerator 3 and denominator 5
 		std::unique_ptr<Fraction> f1 = std::make_unique<Fraction>(3, 5);
-		std::cout << *f1 << '\n';
+		Log() << *f1 << '\n';
 
 		// Create a dynamically allocated array of Fractions of length 4
 		// We can also use automatic type deduction to good effect here
 		auto f2 = std::make_unique<Fraction[]>(4);
-		std::cout << f2[0] << '\n';
+		Log() << f2[0] << '\n';
 	}
 
 	void Cpp14::HeterogeneousLookupAssocContainers()
@@ -145,29 +151,57 @@ namespace MODERNCPP
 		std::sort(foo, foo + 5, std::less<int>());  // 5 10 15 20 25
 		std::sort(bar, bar + 3, std::less<int>());  //   10 15 20
 		if (std::includes(foo, foo + 5, bar, bar + 3, std::less<int>()))
-			std::cout << "foo includes bar.\n";
+			Log() << "foo includes bar.\n";
 
 		// greater
 		int numbers[] = { 20,40,50,10,30 };
 		std::sort(numbers, numbers + 5, std::greater<int>());
 		for (int i = 0; i < 5; i++)
-			std::cout << numbers[i] << ' ';
-		std::cout << '\n';
+			Log() << numbers[i] << ' ';
+		Log() << '\n';
+
+		// transparent comparator: find() takes the literal or string_view as it is, no std::string is built
+		StringMap<int> ports = { { "http", 80 }, { "https", 443 }, { "ssh", 22 } };
+		const std::string_view scheme = "https";
+		auto port = ports.find(scheme);
+		if (port != ports.end())
+			Log() << scheme << " is port " << port->second << '\n';
+		if (!Contains(ports, "ftp"))
+			Log() << "ftp has no port\n";
+	}
+
+	// nthreads hammer one counter, returns million increments per second
+	template <typename Counter>
+	static double CounterThroughput(unsigned nthreads, unsigned increments)
+	{
+		Counter counter;
+		std::vector<std::thread> threads;
+		const auto start = std::chrono::steady_clock::now();
+		for (unsigned t = 0; t < nthreads; t++)
+			threads.emplace_back([&counter, increments] {
+				for (unsigned i = 0; i < increments; i++)
+					counter.increment();
+			});
+		for (auto& t : threads)
+			t.join();
+		const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+		assert(counter.get() == nthreads * increments);
+		return nthreads * increments / elapsed.count();
 	}
 
 	void Cpp14::SharedMutexesLocking()
 	{
-		ThreadSafeCounter counter;
+		ThreadSafeCounter<> counter;
 
 		auto increment_and_print = [&counter]() 
 		{
 			for (int i = 0; i < 3; i++) 
 			{
 				counter.increment();
-				std::cout << std::this_thread::get_id() << ' ' << counter.get() << '\n';
+				Log() << std::this_thread::get_id() << ' ' << counter.get() << '\n';
 
-				// Note: Writing to std::cout actually needs to be synchronized as well
-				// by another std::mutex. This has been omitted to keep the example small.
+				// Note: each Log() statement is one record, lines of the two threads never interleave
 			}
 		};
 
@@ -176,12 +210,23 @@ namespace MODERNCPP
 
 		thread1.join();
 		thread2.join();
+
+		// every writer takes the exclusive lock vs every writer owns a cache line
+		Log() << "threads  shared_mutex Mops/s  sharded Mops/s\n";
+		for (unsigned nthreads = 1; nthreads <= 64; nthreads *= 2)
+		{
+			const unsigned increments = 10'000;
+			Log() << std::setw(7) << nthreads
+				<< std::setw(21) << CounterThroughput<ThreadSafeCounter<SharedMutexCounter>>(nthreads, increments)
+				<< std::setw(16) << CounterThroughput<ThreadSafeCounter<ShardedCounter>>(nthreads, increments)
+				<< '\n';
+		}
 	}
 
 	void Cpp14::DeprecatedMethod()
 	{
-		std::cout << "DeprecatedMethod should display a compile warning!\n"
+		Log() << "DeprecatedMethod should display a compile warning!\n"
 			<< "But somehow not really working, need to figure out why"
-			<< endl;
+			<< '\n';
 	}
 }
\ No newline at end of file
@@ -4,8 +4,11 @@
 #define __MODERN_CPP_14_H
 
 #include "Cpp11.h"
+#include "RingBuffer.h"
 
 #include <regex>
+#include <atomic>
+#include <cstddef>
 #include <iostream>
 #include <mutex>  // For std::unique_lock
 #include <shared_mutex>
@@ -58,9 +61,10 @@ namespace MODERNCPP
 	};
 
 	// Shared mutexes and locking
-	class ThreadSafeCounter {
+	// one value behind a reader/writer lock: readers share, every writer is exclusive
+	class SharedMutexCounter {
 	public:
-		ThreadSafeCounter() = default;
+		SharedMutexCounter() = default;
 
 		// Multiple threads/readers can read the counter's value at the same time.
 		unsigned int get() const {
@@ -85,10 +89,70 @@ namespace MODERNCPP
 		unsigned int value_ = 0;
 	};
 
+	// Writers never share a cache line: each thread increments its own slot with a relaxed
+	// atomic add, get() sums the slots. Scales with writers, but get() is a sum of slots read
+	// one at a time, not a snapshot, and is O(shards).
+	class ShardedCounter {
+	public:
+		static constexpr std::size_t shards = 64;		// threads beyond this share slots round robin
+
+		ShardedCounter() = default;
+
+		unsigned int get() const {
+			unsigned int sum = 0;
+			for (const auto& slot : slots_)
+				sum += slot.value.load(std::memory_order_relaxed);
+			return sum;
+		}
+
+		void increment() {
+			slots_[ThisShard()].value.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// not atomic with respect to concurrent increments
+		void reset() {
+			for (auto& slot : slots_)
+				slot.value.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		struct alignas(cache_line_size) Slot {
+			std::atomic<unsigned int> value{ 0 };
+		};
+
+		// each thread gets the next slot the first time it touches any ShardedCounter
+		static std::size_t ThisShard() {
+			static std::atomic<std::size_t> next{ 0 };
+			thread_local const std::size_t shard = next.fetch_add(1, std::memory_order_relaxed) % shards;
+			return shard;
+		}
+
+		Slot slots_[shards];
+	};
+
+	// the counting strategy is a policy, the interface stays the same
+	template <typename Impl = SharedMutexCounter>
+	class ThreadSafeCounter {
+	public:
+		ThreadSafeCounter() = default;
+
+		unsigned int get() const { return impl_.get(); }
+		void increment() { impl_.increment(); }
+		void reset() { impl_.reset(); }
+
+	private:
+		Impl impl_;
+	};
+
 	class Cpp14 : public Base {
 	public:
 
 		explicit Cpp14() noexcept {}			// cannot called implicitly
+		explicit Cpp14(std::allocator_arg_t, const allocator_type& alloc) noexcept : Base(alloc) {}	// std::pmr, see Base
+		Cpp14(std::allocator_arg_t, const allocator_type& alloc, const Cpp14& other) noexcept : Base(std::allocator_arg, alloc, other), x(other.x) {}
+
+		// overrides
+		const char* getName() const override { return "Cpp14"; }
 
 		// auto return type deduction
 		template<class T, class U>
@@ -1,5 +1,12 @@
 #include "pch.h"
 #include "Cpp17.h"
+#include "Any.h"
+#include "DirectoryScan.h"
+#include "Expected.h"
+#include "Polynomial.h"
+#include "Random.h"
+#include "SpecialMath.h"
+#include "VariantVector.h"
 
 #include <string>
 #include <cassert>
@@ -7,11 +14,14 @@
 #include <algorithm>
 #include <any>
 #include <iostream>
+#include <atomic>
 #include <filesystem>
+#include <random>
 #include <variant>
 #include <exception>
 #include <stdexcept>
 #include <cmath>
+#include <cstddef>
 
 //#define NDEBUG		// disable assert() for release
 
@@ -44,45 +54,52 @@ namespace MODERNCPP::CPP17
 
 	void Cpp17::StdAny()
 	{
-		std::cout << std::boolalpha;
+		Log() << std::boolalpha;
 
 		// any type
 		std::any a = 1;
-		std::cout << a.type().name() << ": " << std::any_cast<int>(a) << '\n';
+		Log() << a.type().name() << ": " << std::any_cast<int>(a) << '\n';
 		a = 3.14;
-		std::cout << a.type().name() << ": " << std::any_cast<double>(a) << '\n';
+		Log() << a.type().name() << ": " << std::any_cast<double>(a) << '\n';
 		a = true;
-		std::cout << a.type().name() << ": " << std::any_cast<bool>(a) << '\n';
+		Log() << a.type().name() << ": " << std::any_cast<bool>(a) << '\n';
 
 		// bad cast
 		try
 		{
 			a = 1;
-			std::cout << std::any_cast<float>(a) << '\n';
+			Log() << std::any_cast<float>(a) << '\n';
 		}
 		catch (const std::bad_any_cast& e)
 		{
-			std::cout << e.what() << '\n';
+			Log() << e.what() << '\n';
 		}
 
 		// has value
 		a = 1;
 		if (a.has_value())
 		{
-			std::cout << a.type().name() << '\n';
+			Log() << a.type().name() << '\n';
 		}
 
 		// reset
 		a.reset();
 		if (!a.has_value())
 		{
-			std::cout << "no value\n";
+			Log() << "no value\n";
 		}
 
 		// pointer to contained data
 		a = 1;
 		int* i = std::any_cast<int>(&a);
-		std::cout << *i << "\n";
+		Log() << *i << "\n";
+
+		// the string fits the inline buffer, no heap block, and the type check needs no RTTI
+		SmallAny<64> small = std::string("inline in SmallAny<64>");
+		if (const std::string* s = AnyCast<std::string>(&small))
+		{
+			Log() << *s << ", holds<int>(): " << small.holds<int>() << '\n';
+		}
 	}
 
 	void Cpp17::StdByte()
@@ -91,37 +108,50 @@ namespace MODERNCPP::CPP17
 		std::byte b = (std::byte) n;
 
 		int x = std::to_integer<int>(b);
-		std::cout << x << endl;
+		Log() << x << '\n';
 	}
 
 	void Cpp17::StdFileSystem()
 	{
 		namespace fs = std::filesystem;	
-		fs::path p = "C:/a/b/c/d/e/f";
-
-		if (!fs::exists(p))
-		{
-			fs::create_directories(p);
-			fs::remove_all("C:/a/");
-		}
-		std::cout << fs::current_path();
+		// a directory of this run's own ("C:/" is a relative directory off Windows), another run or
+		// another user's files in the temp directory are never touched
+		fs::path root;
+		std::mt19937_64& random = ThreadLocalEngine<std::mt19937_64>();
+		do
+			root = fs::temp_directory_path() / ("ModernCpp-" + std::to_string(random()));
+		while (!fs::create_directory(root));			// false: the name was taken
+
+		const fs::path p = root / "a/b/c/d/e/f";
+		fs::create_directories(p);
+
+		// the whole tree, subdirectories read in parallel, see DirectoryScan.h
+		std::atomic<int> directories{ 0 };
+		ScanDirectory(root, [&directories](const ScanEntry& e) {
+			directories += e.type == fs::file_type::directory;
+			return true;
+		});
+		Log() << directories << " directories below the run's temporary directory\n";
+
+		fs::remove_all(root);
+		Log() << fs::current_path();
 	}
 
 	void Cpp17::StdOptional()
 	{
-		std::cout << "create1(false) returned "
+		Log() << "create1(false) returned "
 			<< create1(false).value_or("empty") << '\n';
 
 		// optional-returning factory functions are usable as conditions of while and if
 		if (auto str = create2(true)) {
-			std::cout << "create2(true) returned " << *str << '\n';
+			Log() << "create2(true) returned " << *str << '\n';
 		}
 
 		if (auto str = create_ref(true)) {
 			// using get() to access the reference_wrapper's value
-			std::cout << "create_ref(true) returned " << str->get() << '\n';
+			Log() << "create_ref(true) returned " << str->get() << '\n';
 			str->get() = "Mothra";
-			std::cout << "modifying it changed it to " << str->get() << '\n';
+			Log() << "modifying it changed it to " << str->get() << '\n';
 		}
 	}
 
@@ -142,13 +172,38 @@ namespace MODERNCPP::CPP17
 		}
 		catch (const std::bad_variant_access&) {}
 
+		// the same check with the failure as the return value, no throw
+		auto get_float = [](const std::variant<int, float>& v) -> Expected<float, const char*> {
+			if (const float* f = std::get_if<float>(&v))
+				return *f;
+			return Unexpected("w contains int, not float");
+		};
+		const float f = get_float(w).or_else([](const char* e) -> Expected<float, const char*> {
+			Log() << "get_float(w) failed: " << e << '\n';
+			return 0.0f;
+		}).value();
+		Log() << "get_float(w) fell back to " << f << '\n';
+
 		std::variant<std::string> x("abc"); // converting constructors work when unambiguous
 		x = "def"; // converting assignment also works when unambiguous
 
-		std::variant<std::string, bool> y("abc"); // casts to bool when passed a char const *
-		assert(std::holds_alternative<bool>(y)); // succeeds
+		std::variant<std::string, bool> y("abc"); // casts to bool when passed a char const * (std::string once P0608 is implemented, GCC 10+)
+		assert(std::holds_alternative<bool>(y) || std::holds_alternative<std::string>(y)); // succeeds
 		y = "xyz"s;
 		assert(std::holds_alternative<std::string>(y)); //succeeds
+
+		// many variants: an array per alternative, visited alternative by alternative without a dispatch each
+		VariantVector<int, float> many;
+		for (int k = 0; k < 6; ++k)
+		{
+			if (k % 2)
+				many.push_back(k * 0.5f);
+			else
+				many.push_back(k);
+		}
+		float total = 0;
+		many.visit_all([&total](auto x) { total += x; });
+		Log() << many.column<int>().size() << " ints, " << many.column<float>().size() << " floats, sum " << total << '\n';
 	}
 
 	void Cpp17::StdConjunction()
@@ -166,9 +221,9 @@ namespace MODERNCPP::CPP17
 			std::disjunction<std::bool_constant<true>, std::bool_constant<false>,
 			std::bool_constant<false>>;
 
-		std::cout << std::boolalpha;
-		std::cout << result0::value << '\n';
-		std::cout << result1::value << '\n';
+		Log() << std::boolalpha;
+		Log() << result0::value << '\n';
+		Log() << result1::value << '\n';
 	}
 
 	void Cpp17::StdNegation()
@@ -184,9 +239,9 @@ namespace MODERNCPP::CPP17
 			typename std::negation<std::bool_constant<false>>::type>::value,
 			"");
 
-		std::cout << std::boolalpha;
-		std::cout << std::negation<std::bool_constant<true>>::value << '\n';
-		std::cout << std::negation<std::bool_constant<false>>::value << '\n';
+		Log() << std::boolalpha;
+		Log() << std::negation<std::bool_constant<true>>::value << '\n';
+		Log() << std::negation<std::bool_constant<false>>::value << '\n';
 	}
 
 	void Cpp17::StdUncaughtExceptions()
@@ -194,7 +249,7 @@ namespace MODERNCPP::CPP17
 		struct Foo {
 			int count = std::uncaught_exceptions();
 			~Foo() {
-				std::cout << (count == std::uncaught_exceptions()
+				Log() << (count == std::uncaught_exceptions()
 					? "~Foo() called normally\n"
 					: "~Foo() called during stack unwinding\n");
 			}
@@ -203,12 +258,22 @@ namespace MODERNCPP::CPP17
 		Foo f;
 		try {
 			Foo f;
-			std::cout << "Exception thrown\n";
+			Log() << "Exception thrown\n";
 			throw std::runtime_error("test exception");
 		}
 		catch (const std::exception& e) {
-			std::cout << "Exception caught: " << e.what() << '\n';
+			Log() << "Exception caught: " << e.what() << '\n';
 		}
+
+		// the same failure returned: nothing unwinds, so this Foo is destroyed normally
+		auto test = [](bool fail) -> Expected<int, const char*> {
+			Foo f;
+			if (fail)
+				return Unexpected("test error");
+			return 1;
+		};
+		if (const auto r = test(true).transform([](int n) { return n + 1; }); !r)
+			Log() << "Error returned: " << r.error() << '\n';
 	}
 
 	void Cpp17::StructuredBindingDeclaration()
@@ -216,7 +281,7 @@ namespace MODERNCPP::CPP17
 		// used structured binding declaration to put results of tuple in variables a and b
 		auto[a, b] = returnTuple(); 
 
-		std::cout << a << ' ' << b << '\n';
+		Log() << a << ' ' << b << '\n';
 	}
 
 	void Cpp17::IfSwitchInitializer()
@@ -224,25 +289,25 @@ namespace MODERNCPP::CPP17
 		auto getval = [value = 1]{ return value; };
 
 		if (auto a = getval(); a < 10) {
-			std::cout << a << endl;
+			Log() << a << '\n';
 		}
 
 		switch (auto b = getval(); b) {
 		case 1:
-			std::cout << b << endl;
+			Log() << b << '\n';
 			break;
 		}
 	}
 
 	void Cpp17::InlineVariable()
 	{
-		std::cout << inline_variable << endl;
+		Log() << inline_variable << '\n';
 	}
 
 	void Cpp17::FoldExpression()
 	{
-		cout << sum1(1, 2, 3, 4, 5, 6, 7) << "\n";
-		cout << sum2(1, 2, 3, 4, 5, 6, 7) << "\n";
+		Log() << sum1(1, 2, 3, 4, 5, 6, 7) << "\n";
+		Log() << sum2(1, 2, 3, 4, 5, 6, 7) << "\n";
 
 		FoldPrint("hello", ", ", 10, ", ", 90.0);
 
@@ -250,34 +315,34 @@ namespace MODERNCPP::CPP17
 		FoldPushBack(v, 1, 2, 3, 4);
 
 		for (auto &i : v)
-			std::cout << i << "\n";
+			Log() << i << "\n";
 	}
 
 	void Cpp17::RemovedTrigraphs()
 	{
-		std::cout << "??=" << " ";		// #
-		std::cout << "??//" << " ";		// /
-		std::cout << "??'" << " ";		// ^
-		std::cout << "??)" << " ";		// ]
-		std::cout << "??(" << " ";		// [
-		std::cout << "??!" << " ";		// |
-		std::cout << "??<" << " ";		// {
-		std::cout << "??>" << " ";		// }
-		std::cout << "??-" << " ";		// ~
-		std::cout << std::endl;
+		Log() << "??=" << " ";		// #
+		Log() << "??//" << " ";		// /
+		Log() << "??'" << " ";		// ^
+		Log() << "??)" << " ";		// ]
+		Log() << "??(" << " ";		// [
+		Log() << "??!" << " ";		// |
+		Log() << "??<" << " ";		// {
+		Log() << "??>" << " ";		// }
+		Log() << "??-" << " ";		// ~
+		Log() << '\n';
 	}
 
 	void Cpp17::Utf8Literals()
 	{
 		auto h = u8"Hello World";
-		std::cout << h << endl;
+		Log() << h << '\n';
 	}
 
 	void Cpp17::HexFloatingPointLiterals()
 	{
 		double d = 0x1.2p3; // hex fraction 1.2 (decimal 1.125) scaled by 2^3, that is 9.0
 
-		std::cout << 58. << '\n'
+		Log() << 58. << '\n'
 			<< 4e2 << '\n'
 			<< 123.456e-67 << '\n'
 			<< .1E4f << '\n'
@@ -289,7 +354,7 @@ namespace MODERNCPP::CPP17
 	{
 		// similar to call TemplateArgumentDeduction
 		auto [a, b] = std::pair(5.0, false);		// instead of std::pair<double, bool>(5.0, false)
-		std::cout << a << " " << b << endl;
+		Log() << a << " " << b << '\n';
 	}
 
 	// suppresses compiler warnings about unused param entities.
@@ -319,63 +384,74 @@ namespace MODERNCPP::CPP17
 		auto binom = [](int n, int k) { return 1 / ((n + 1)*std::beta(n - k + 1, k + 1)); };
 
 		// associated Laguerre polynomials 
-		std::cout << std::assoc_laguerre(1, 10, 0.5) << endl;
+		Log() << std::assoc_laguerre(1, 10, 0.5) << '\n';
 
 		// associated Legendre polynomials 
-		std::cout << std::assoc_legendre(1, 10, 0.5) << endl;
+		Log() << std::assoc_legendre(1, 10, 0.5) << '\n';
 
 		// beta function
-		std::cout << binom(1, 5) << endl;
+		Log() << binom(1, 5) << '\n';
 
 		// (complete)elliptic integral of the first kind
-		std::cout << std::comp_ellint_1(3.14159) << endl;
+		Log() << std::comp_ellint_1(3.14159) << '\n';
 
-		// (complete) elliptic integral of the second kind 
-		std::cout << std::comp_ellint_2(3.14159) << endl;
+		// (complete) elliptic integral of the second kind, |k| > 1 is a domain error (nan on MSVC, libstdc++ throws)
+		// Catching turns the throw into a value, printed only if there is one
+		if (const auto e2 = Catching([] { return std::comp_ellint_2(3.14159); }))
+			Log() << *e2 << '\n';
 
 		// (complete) elliptic integral of the third kind 
-		std::cout << std::comp_ellint_3(3.14159, 1.0) << endl;
+		Log() << std::comp_ellint_3(3.14159, 1.0) << '\n';
 
 		// regular modified cylindrical Bessel functions 
-		std::cout << std::cyl_bessel_i(0, 1.2345) << endl;
+		Log() << std::cyl_bessel_i(0, 1.2345) << '\n';
 
 		// cylindrical Bessel functions (of the first kind) 
-		std::cout << std::cyl_bessel_j(0, 1.2345) << endl;
+		Log() << std::cyl_bessel_j(0, 1.2345) << '\n';
 
 		// irregular modified cylindrical Bessel functions
-		std::cout << std::cyl_bessel_k(0, 1.2345) << endl;
+		Log() << std::cyl_bessel_k(0, 1.2345) << '\n';
 
 		// cylindrical Neumann functions 
-		std::cout << std::cyl_neumann(0.5, 1.2345) << endl;
+		Log() << std::cyl_neumann(0.5, 1.2345) << '\n';
 
 		// cylindrical Neumann functions 
-		std::cout << std::ellint_1(0.5, 1.2345) << endl;
+		Log() << std::ellint_1(0.5, 1.2345) << '\n';
 
 		// (incomplete)elliptic integral of the second kind
-		std::cout << std::ellint_2(0.5, 1.2345) << endl;
+		Log() << std::ellint_2(0.5, 1.2345) << '\n';
 
 		// exponential integral
-		std::cout << std::expint(0) << endl;
+		Log() << std::expint(0) << '\n';
 
 		// hermite polynomials 
-		std::cout << std::hermite(3, 10) << endl;
+		Log() << std::hermite(3, 10) << '\n';
 
 		// Legendre polynomials 
-		std::cout << std::legendre(3, 10) << endl;
+		Log() << std::legendre(3, 10) << '\n';
 
 		// Laguerre polynomials 
-		std::cout << std::laguerre(3, 10) << endl;
+		Log() << std::laguerre(3, 10) << '\n';
 
 		// Riemann zeta function 
-		std::cout << std::riemann_zeta(3) << endl;
+		Log() << std::riemann_zeta(3) << '\n';
 
 		// spherical Bessel functions (of the first kind) 
-		std::cout << std::sph_bessel(3, 6) << endl;
+		Log() << std::sph_bessel(3, 6) << '\n';
 
 		// spherical associated Legendre functions 
-		std::cout << std::sph_legendre(3, 6, 9.0) << endl;
+		Log() << std::sph_legendre(3, 6, 9.0) << '\n';
 
 		// spherical Neumann functions 
-		std::cout << std::sph_neumann(3, 6.0) << endl;
+		Log() << std::sph_neumann(3, 6.0) << '\n';
+
+		// a whole array of points in one call, see SpecialMath.h
+		const double xs[] = { -1.0, -0.5, 0.0, 0.5, 1.0 };
+		double ps[std::size(xs)];
+		BATCH::Legendre(3, xs, ps, std::size(xs));
+		Log() << ps[0] << ' ' << ps[1] << ' ' << ps[2] << ' ' << ps[3] << ' ' << ps[4] << '\n';
+
+		// degree known at compile time: the compiler worked out the coefficients, see Polynomial.h
+		Log() << POLY::Legendre<3>(10) << ' ' << POLY::Hermite<3>(10) << ' ' << POLY::Laguerre<3>(10) << '\n';
 	}
 }
\ No newline at end of file
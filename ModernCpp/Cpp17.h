@@ -4,6 +4,9 @@
 #define __MODERN_CPP_17_H
 
 #include "Cpp11.h"
+#include "Log.h"
+
+#include <iostream>
 
 // C++17 __has_include
 #ifdef __has_include						   // Check if __has_include is present
@@ -37,6 +40,11 @@ namespace MODERNCPP::CPP17		// C++17, nested namespace
 	public:
 
 		explicit Cpp17() noexcept {}			// cannot called implicitly
+		explicit Cpp17(std::allocator_arg_t, const allocator_type& alloc) noexcept : Base(alloc) {}	// std::pmr, see Base
+		Cpp17(std::allocator_arg_t, const allocator_type& alloc, const Cpp17& other) noexcept : Base(std::allocator_arg, alloc, other) {}
+
+		// overrides
+		const char* getName() const override { return "Cpp17"; }
 
 		// auto return type deduction
 		template<typename T, typename U, typename V>
@@ -122,7 +130,7 @@ namespace MODERNCPP::CPP17		// C++17, nested namespace
 
 		template<typename ...Args>
 		void FoldPrint(Args&&... args) {
-			(std::cout << ... << forward<Args>(args)) << '\n';
+			(Log() << ... << forward<Args>(args)) << '\n';
 		}
 
 		template<typename T, typename... Args>
@@ -136,14 +144,14 @@ namespace MODERNCPP::CPP17		// C++17, nested namespace
 		template<typename T, typename... Ts>
 		std::enable_if_t<std::conjunction_v<std::is_same<T, Ts>...>>
 			func(T, Ts...) {
-			std::cout << "all types in pack are T\n";
+			Log() << "all types in pack are T\n";
 		}
 
 		// otherwise
 		template<typename T, typename... Ts>
 		std::enable_if_t<!std::conjunction_v<std::is_same<T, Ts>...>>
 			func(T, Ts...) {
-			std::cout << "not all types in pack are T\n";
+			Log() << "not all types in pack are T\n";
 		}
 
 	private:
@@ -0,0 +1,314 @@
+#include "pch.h"
+#include "DirectoryScan.h"
+#include "ThreadPool.h"
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <exception>
+#include <system_error>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+namespace MODERNCPP
+{
+	namespace
+	{
+		namespace fs = std::filesystem;
+
+		bool IsSeparator(char c) { return c == '/' || c == '\\'; }
+
+		// one ScanDirectory call, shared by all of its tasks
+		class Scan {
+		public:
+
+			Scan(const fs::path& root, const ScanVisitor& visit, ScanOptions options);
+			~Scan();
+
+			ScanResult Run();
+
+		private:
+
+			void Post(std::string dir, unsigned depth);
+			void Read(const std::string& dir, unsigned depth);		// visits the entries, posts the subdirectories
+			void Fail(std::exception_ptr error);
+
+			// dir, then a separator unless dir already ends with one
+			std::string Child(const std::string& dir) const
+			{
+				std::string path = dir;
+				if (path.empty() || !IsSeparator(path.back()))
+					path += '/';
+				return path;
+			}
+
+			ThreadPool& m_pool = ThreadPool::Instance();
+			const std::string m_root;
+			std::size_t m_base = 0;									// where a path below the root starts
+			const ScanVisitor& m_visit;
+			const ScanOptions m_options;
+
+			std::atomic<std::size_t> m_pending{ 0 };				// directories posted, not read yet
+			std::atomic<std::size_t> m_files{ 0 };
+			std::atomic<std::size_t> m_directories{ 0 };
+			std::atomic<std::size_t> m_errors{ 0 };
+			std::atomic<bool> m_stop{ false };
+
+			std::mutex m_mutex;
+			std::exception_ptr m_error;								// the first one, under m_mutex
+
+#if defined(__linux__)
+			int m_rootFd = -1;										// subdirectories open relative to it
+#endif
+		};
+
+		Scan::Scan(const fs::path& root, const ScanVisitor& visit, ScanOptions options)
+			: m_root(root.u8string()), m_visit(visit), m_options(options)
+		{
+			m_base = Child(m_root).size();
+#if defined(__linux__)
+			m_rootFd = open(m_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if (m_rootFd < 0)
+				throw fs::filesystem_error("ScanDirectory", root, std::error_code(errno, std::generic_category()));
+#else
+			std::error_code ec;
+			fs::directory_iterator probe(root, ec);
+			if (ec)
+				throw fs::filesystem_error("ScanDirectory", root, ec);
+#endif
+		}
+
+		Scan::~Scan()
+		{
+#if defined(__linux__)
+			close(m_rootFd);
+#endif
+		}
+
+		ScanResult Scan::Run()
+		{
+			Post(m_root, 0);
+			m_pool.help_while([this] { return m_pending.load(std::memory_order_acquire) != 0; });
+
+			if (m_error)
+				std::rethrow_exception(m_error);
+			return { m_files.load(), m_directories.load(), m_errors.load() };
+		}
+
+		void Scan::Post(std::string dir, unsigned depth)
+		{
+			m_pending.fetch_add(1, std::memory_order_relaxed);
+			m_pool.post([this, dir = std::move(dir), depth] {
+				// a pool task swallows exceptions, this one must count down whatever happens
+				try
+				{
+					if (!m_stop.load(std::memory_order_relaxed))
+						Read(dir, depth);
+				}
+				catch (...)
+				{
+					Fail(std::current_exception());
+				}
+				m_pending.fetch_sub(1, std::memory_order_release);
+			});
+		}
+
+		void Scan::Fail(std::exception_ptr error)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_error)
+				m_error = error;
+			m_stop.store(true, std::memory_order_relaxed);
+		}
+
+#if defined(__linux__)
+		// what getdents64 fills the buffer with, glibc has no declaration of it
+		struct Dirent64 {
+			std::uint64_t d_ino;
+			std::int64_t d_off;
+			unsigned short d_reclen;
+			unsigned char d_type;
+			char d_name[1];
+		};
+
+		fs::file_type TypeOf(unsigned char type)
+		{
+			switch (type)
+			{
+			case DT_REG: return fs::file_type::regular;
+			case DT_DIR: return fs::file_type::directory;
+			case DT_LNK: return fs::file_type::symlink;
+			case DT_BLK: return fs::file_type::block;
+			case DT_CHR: return fs::file_type::character;
+			case DT_FIFO: return fs::file_type::fifo;
+			case DT_SOCK: return fs::file_type::socket;
+			default: return fs::file_type::unknown;		// the file system does not fill d_type
+			}
+		}
+
+		fs::file_type TypeOfMode(unsigned mode)
+		{
+			switch (mode & S_IFMT)
+			{
+			case S_IFREG: return fs::file_type::regular;
+			case S_IFDIR: return fs::file_type::directory;
+			case S_IFLNK: return fs::file_type::symlink;
+			case S_IFBLK: return fs::file_type::block;
+			case S_IFCHR: return fs::file_type::character;
+			case S_IFIFO: return fs::file_type::fifo;
+			case S_IFSOCK: return fs::file_type::socket;
+			default: return fs::file_type::unknown;
+			}
+		}
+
+		std::chrono::system_clock::time_point TimeOf(std::int64_t seconds, std::uint32_t nanoseconds)
+		{
+			using namespace std::chrono;
+			return system_clock::time_point(duration_cast<system_clock::duration>(std::chrono::seconds(seconds) + std::chrono::nanoseconds(nanoseconds)));
+		}
+
+		// the entry by its name in the open directory, no path lookup from the root
+		void Stat(int dirFd, const char* name, ScanEntry& e)
+		{
+#ifdef STATX_TYPE
+			struct statx sx;
+			if (statx(dirFd, name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT, STATX_TYPE | STATX_SIZE | STATX_MTIME, &sx) != 0)
+				return;
+			e.type = TypeOfMode(sx.stx_mode);
+			e.size = e.type == fs::file_type::regular ? sx.stx_size : 0;
+			e.mtime = TimeOf(sx.stx_mtime.tv_sec, sx.stx_mtime.tv_nsec);
+#else
+			struct stat st;
+			if (fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+				return;
+			e.type = TypeOfMode(st.st_mode);
+			e.size = e.type == fs::file_type::regular ? st.st_size : 0;
+			e.mtime = TimeOf(st.st_mtim.tv_sec, st.st_mtim.tv_nsec);
+#endif
+		}
+
+		void Scan::Read(const std::string& dir, unsigned depth)
+		{
+			// relative to the root, the root itself is "."
+			const char* relative = dir.size() > m_root.size() ? dir.c_str() + m_base : ".";
+			const int fd = openat(m_rootFd, relative, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+			if (fd < 0)
+			{
+				m_errors.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			struct Closer {
+				int fd;
+				~Closer() { close(fd); }
+			} closer{ fd };
+
+			std::string path = Child(dir);
+			const std::size_t base = path.size();
+			std::size_t files = 0, directories = 0;
+
+			alignas(8) char buffer[32 * 1024];
+			while (!m_stop.load(std::memory_order_relaxed))
+			{
+				const long n = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+				if (n <= 0)
+				{
+					if (n < 0)
+						m_errors.fetch_add(1, std::memory_order_relaxed);
+					break;
+				}
+				for (long offset = 0; offset < n && !m_stop.load(std::memory_order_relaxed);)
+				{
+					const Dirent64* d = reinterpret_cast<const Dirent64*>(buffer + offset);
+					const char* name = buffer + offset + offsetof(Dirent64, d_name);
+					offset += d->d_reclen;
+					if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+						continue;
+
+					path.resize(base);
+					path += name;
+					ScanEntry e{ path, std::string_view(path).substr(base), TypeOf(d->d_type), 0, {}, depth };
+					if (m_options.metadata || e.type == fs::file_type::unknown)
+						Stat(fd, name, e);
+
+					const bool descend = m_visit(e);
+					if (e.type == fs::file_type::directory)
+					{
+						++directories;
+						if (descend)
+							Post(path, depth + 1);
+					}
+					else
+						++files;
+				}
+			}
+			m_files.fetch_add(files, std::memory_order_relaxed);
+			m_directories.fetch_add(directories, std::memory_order_relaxed);
+		}
+#else
+		// C++17 has no file_clock::to_sys, the offset between the clocks does it to a few microseconds
+		std::chrono::system_clock::time_point TimeOf(fs::file_time_type t)
+		{
+			using namespace std::chrono;
+			return system_clock::now() + duration_cast<system_clock::duration>(t - fs::file_time_type::clock::now());
+		}
+
+		void Scan::Read(const std::string& dir, unsigned depth)
+		{
+			std::error_code ec;
+			fs::directory_iterator it(fs::u8path(dir), fs::directory_options::skip_permission_denied, ec);
+			if (ec)
+			{
+				m_errors.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			std::string path = Child(dir);
+			const std::size_t base = path.size();
+			std::size_t files = 0, directories = 0;
+
+			for (; it != fs::directory_iterator() && !m_stop.load(std::memory_order_relaxed); it.increment(ec))
+			{
+				const fs::directory_entry& entry = *it;
+				path.resize(base);
+				path += entry.path().filename().u8string();
+				ScanEntry e{ path, std::string_view(path).substr(base), entry.symlink_status(ec).type(), 0, {}, depth };
+				if (m_options.metadata)
+				{
+					std::error_code missing;			// gone since it was listed, reported without
+					if (e.type == fs::file_type::regular)
+						e.size = entry.file_size(missing);
+					const fs::file_time_type t = entry.last_write_time(missing);
+					if (!missing)
+						e.mtime = TimeOf(t);
+				}
+
+				const bool descend = m_visit(e);
+				if (e.type == fs::file_type::directory)
+				{
+					++directories;
+					if (descend)
+						Post(path, depth + 1);
+				}
+				else
+					++files;
+			}
+			if (ec)
+				m_errors.fetch_add(1, std::memory_order_relaxed);
+			m_files.fetch_add(files, std::memory_order_relaxed);
+			m_directories.fetch_add(directories, std::memory_order_relaxed);
+		}
+#endif
+	}
+
+	ScanResult ScanDirectory(const std::filesystem::path& root, const ScanVisitor& visit, ScanOptions options)
+	{
+		Scan scan(root, visit, options);
+		return scan.Run();
+	}
+}
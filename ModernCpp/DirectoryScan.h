@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef __MODERN_CPP_DIRECTORY_SCAN_H
+#define __MODERN_CPP_DIRECTORY_SCAN_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <filesystem>
+#include <string_view>
+
+// Parallel recursive directory walk: every directory is a ThreadPool task, the subdirectories it
+// finds go to the deque of the worker that found them (depth first, hot in its cache) and idle
+// workers steal them. On Linux a directory is read with openat + getdents64 and its entries are
+// measured with statx relative to it, elsewhere std::filesystem::directory_iterator does the work.
+//
+//   ScanDirectory(root, [](const ScanEntry& e) { Index(e.path, e.size); return true; });
+//
+// The visitor runs on several threads at once. Like recursive_directory_iterator, the root is not
+// visited and symbolic links are reported but not followed.
+
+namespace MODERNCPP
+{
+	struct ScanEntry {
+		std::string_view path;							// root / ... / name, valid during the call only
+		std::string_view name;							// the last component of path
+		std::filesystem::file_type type;
+		std::uintmax_t size;							// regular files, with ScanOptions::metadata
+		std::chrono::system_clock::time_point mtime;	// with ScanOptions::metadata
+		unsigned depth;									// 0 for the entries of the root
+	};
+
+	struct ScanOptions {
+		bool metadata = true;		// size and mtime, one statx per entry; off, only the type is known
+	};
+
+	struct ScanResult {
+		std::size_t files = 0;		// everything that is not a directory
+		std::size_t directories = 0;
+		std::size_t errors = 0;		// directories that could not be read, left out
+	};
+
+	// return false for a directory to leave out what is below it
+	using ScanVisitor = std::function<bool(const ScanEntry&)>;
+
+	// throws std::filesystem::filesystem_error if root can not be read and rethrows the first exception
+	// of the visitor, once the tasks already running have stopped
+	ScanResult ScanDirectory(const std::filesystem::path& root, const ScanVisitor& visit, ScanOptions options = {});
+}
+
+#endif
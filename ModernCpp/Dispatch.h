@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef __MODERN_CPP_DISPATCH_H
+#define __MODERN_CPP_DISPATCH_H
+
+#include "Cpp11.h"
+#include "Cpp14.h"
+#include "Cpp17.h"
+#include "VariantVector.h"
+
+#include <variant>
+
+// Static dispatch for the Base hierarchy: the classes are a closed set, so a std::variant can hold any
+// of them by value, and std::visit calls each class's own methods directly, where a Base& goes through
+// the vtable and the call can not be inlined.
+// A std::vector<BaseVariant> pads every object to the largest class (Cpp11), a BaseVector keeps one
+// array per class instead, and visit_all runs each array with its type known: that is the way to hold
+// many of them.
+//
+//   BaseVector v;
+//   v.push_back(Cpp11());
+//   v.visit_all([&](const auto& o) { sum += DISPATCH::Value(o); });
+//
+// https://en.cppreference.com/w/cpp/utility/variant/visit
+
+namespace MODERNCPP
+{
+	using BaseVariant = std::variant<Base, Cpp11, Cpp14, CPP17::Cpp17>;
+	using BaseVector = VariantVector<Base, Cpp11, Cpp14, CPP17::Cpp17>;
+
+	namespace DISPATCH
+	{
+		// inside a variant or a BaseVector the object is exactly T, the qualified call skips the vtable
+		template <typename T>
+		const char* Name(const T& o) { return o.T::getName(); }
+
+		template <typename T>
+		int Value(const T& o) { return o.T::getValue(); }
+	}
+
+	inline const char* GetName(const BaseVariant& v) { return std::visit([](const auto& o) { return DISPATCH::Name(o); }, v); }
+	inline int GetValue(const BaseVariant& v) { return std::visit([](const auto& o) { return DISPATCH::Value(o); }, v); }
+
+	// for everything else, still virtual
+	inline Base& AsBase(BaseVariant& v) { return std::visit([](auto& o) -> Base& { return o; }, v); }
+	inline const Base& AsBase(const BaseVariant& v) { return std::visit([](const auto& o) -> const Base& { return o; }, v); }
+
+	// element i of a BaseVector, the same way
+	inline const char* GetName(const BaseVector& v, std::size_t i) { return v.visit(i, [](const auto& o) { return DISPATCH::Name(o); }); }
+	inline int GetValue(const BaseVector& v, std::size_t i) { return v.visit(i, [](const auto& o) { return DISPATCH::Value(o); }); }
+
+	inline Base& AsBase(BaseVector& v, std::size_t i) { return v.visit(i, [](auto& o) -> Base& { return o; }); }
+	inline const Base& AsBase(const BaseVector& v, std::size_t i) { return v.visit(i, [](const auto& o) -> const Base& { return o; }); }
+}
+
+#endif
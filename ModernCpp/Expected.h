@@ -0,0 +1,470 @@
+#pragma once
+
+#ifndef __MODERN_CPP_EXPECTED_H
+#define __MODERN_CPP_EXPECTED_H
+
+#include <new>
+#include <utility>
+#include <exception>
+#include <functional>
+#include <type_traits>
+
+// C++23's std::expected for C++17: a value or the error that kept it from being computed, returned
+// rather than thrown. A failure costs what returning it costs, where a throw unwinds the stack through
+// the runtime's tables and takes microseconds.
+//
+//   Expected<int, const char*> Parse(std::string_view s);
+//   const auto stored = Parse(text).transform([](int n) { return n * 2; })
+//       .and_then(Store);									// skipped once there is an error
+//   if (!stored)
+//       Log() << stored.error();
+//
+// Expected is [[nodiscard]]: a result dropped on the floor is an error nobody saw, the compiler warns.
+// Catching() turns a call that throws into an Expected at the boundary to such code.
+// https://en.cppreference.com/w/cpp/utility/expected
+
+namespace MODERNCPP
+{
+	template <typename E>
+	class Unexpected {
+	public:
+
+		explicit Unexpected(const E& error) : m_error(error) {}
+		explicit Unexpected(E&& error) : m_error(std::move(error)) {}
+
+		E& error() & noexcept { return m_error; }
+		const E& error() const & noexcept { return m_error; }
+		E&& error() && noexcept { return std::move(m_error); }
+
+	private:
+
+		E m_error;
+	};
+
+	template <typename E>
+	Unexpected(E) -> Unexpected<E>;
+
+	// constructs the error in place: Expected<T, E>(unexpect, args...)
+	struct unexpect_t {
+		explicit unexpect_t() = default;
+	};
+	inline constexpr unexpect_t unexpect{};
+
+	// what value() throws when there is an error, the one place Expected throws
+	template <typename E>
+	class BadExpectedAccess : public std::exception {
+	public:
+
+		explicit BadExpectedAccess(E error) : m_error(std::move(error)) {}
+
+		const char* what() const noexcept override { return "bad Expected access"; }
+		const E& error() const noexcept { return m_error; }
+
+	private:
+
+		E m_error;
+	};
+
+	template <typename T, typename E>
+	class Expected;
+
+	namespace DETAIL
+	{
+		template <typename T>
+		struct IsExpected : std::false_type {};
+		template <typename T, typename E>
+		struct IsExpected<Expected<T, E>> : std::true_type {};
+
+		template <typename T>
+		struct IsUnexpected : std::false_type {};
+		template <typename E>
+		struct IsUnexpected<Unexpected<E>> : std::true_type {};
+
+		template <typename T>
+		using Plain = std::remove_cv_t<std::remove_reference_t<T>>;
+
+		// f(args...) as an Expected<U, E> whatever f returns, void included
+		template <typename U, typename E, typename F, typename... Args>
+		Expected<U, E> Wrap(F&& f, Args&&... args)
+		{
+			if constexpr (std::is_void_v<U>)
+			{
+				std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+				return Expected<U, E>();
+			}
+			else
+				return Expected<U, E>(std::in_place, std::invoke(std::forward<F>(f), std::forward<Args>(args)...));
+		}
+
+		// a tagged union rather than std::variant: a variant's one byte index, stored and reloaded as
+		// part of a wider word, stalls store forwarding at every frame the result is returned through
+		template <typename T, typename E, bool = std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<E>>
+		struct Storage {
+			template <typename... Args>
+			explicit Storage(std::in_place_index_t<0>, Args&&... args) : value(std::forward<Args>(args)...), has(true) {}
+			template <typename... Args>
+			explicit Storage(std::in_place_index_t<1>, Args&&... args) : error(std::forward<Args>(args)...), has(false) {}
+
+			union {
+				T value;
+				E error;
+			};
+			bool has;
+		};
+
+		// the members the union can not have by default. An assignment that changes the alternative
+		// leaves the old one in place when the new one throws, as std::expected does, where a variant
+		// would be left valueless.
+		template <typename T, typename E>
+		struct Storage<T, E, false> {
+			template <typename... Args>
+			explicit Storage(std::in_place_index_t<0>, Args&&... args) : value(std::forward<Args>(args)...), has(true) {}
+			template <typename... Args>
+			explicit Storage(std::in_place_index_t<1>, Args&&... args) : error(std::forward<Args>(args)...), has(false) {}
+
+			Storage(const Storage& other) : has(other.has) { Construct(other); }
+			Storage(Storage&& other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_constructible_v<E>)
+				: has(other.has) { Construct(std::move(other)); }
+
+			Storage& operator=(const Storage& other) { Assign(other); return *this; }
+			Storage& operator=(Storage&& other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_constructible_v<E>
+				&& std::is_nothrow_move_assignable_v<T> && std::is_nothrow_move_assignable_v<E>) { Assign(std::move(other)); return *this; }
+
+			~Storage() { Destroy(); }
+
+			union {
+				T value;
+				E error;
+			};
+			bool has;
+
+		private:
+
+			template <typename S>
+			void Construct(S&& other)
+			{
+				if (has)
+					new (&value) T(std::forward<S>(other).value);
+				else
+					new (&error) E(std::forward<S>(other).error);
+			}
+
+			template <typename S>
+			void Assign(S&& other)
+			{
+				if (this == &other)
+					return;
+				if (has == other.has)
+				{
+					if (has)
+						value = std::forward<S>(other).value;
+					else
+						error = std::forward<S>(other).error;
+					return;
+				}
+				if (other.has)
+					Reinit(value, error, std::forward<S>(other).value);
+				else
+					Reinit(error, value, std::forward<S>(other).error);
+				has = other.has;
+			}
+
+			// older's member destroyed, newer's built from args, older back if that throws
+			template <typename New, typename Old, typename... Args>
+			static void Reinit(New& newer, Old& older, Args&&... args)
+			{
+				if constexpr (std::is_nothrow_constructible_v<New, Args...>)
+				{
+					older.~Old();
+					new (&newer) New(std::forward<Args>(args)...);
+				}
+				else if constexpr (std::is_nothrow_move_constructible_v<New>)
+				{
+					New built(std::forward<Args>(args)...);
+					older.~Old();
+					new (&newer) New(std::move(built));
+				}
+				else
+				{
+					static_assert(std::is_nothrow_move_constructible_v<Old>, "assigning an Expected needs T or E to move without throwing");
+					Old saved(std::move(older));
+					older.~Old();
+					try
+					{
+						new (&newer) New(std::forward<Args>(args)...);
+					}
+					catch (...)
+					{
+						new (&older) Old(std::move(saved));
+						throw;
+					}
+				}
+			}
+
+			void Destroy() noexcept
+			{
+				if (has)
+					value.~T();
+				else
+					error.~E();
+			}
+		};
+
+		struct Empty {};
+	}
+
+	template <typename T, typename E>
+	class [[nodiscard]] Expected {
+		static_assert(!std::is_reference_v<T> && !std::is_reference_v<E>, "Expected holds values, not references");
+		static_assert(!DETAIL::IsUnexpected<T>::value, "Expected<Unexpected<...>, E> would be ambiguous");
+
+	public:
+
+		using value_type = T;
+		using error_type = E;
+		using unexpected_type = Unexpected<E>;
+
+		template <typename U>
+		using rebind = Expected<U, E>;
+
+		Expected() : m_storage(std::in_place_index<0>) {}
+
+		template <typename U = T, typename = std::enable_if_t<std::is_constructible_v<T, U&&>
+			&& !std::is_same_v<DETAIL::Plain<U>, Expected> && !std::is_same_v<DETAIL::Plain<U>, std::in_place_t>
+			&& !std::is_same_v<DETAIL::Plain<U>, unexpect_t> && !DETAIL::IsUnexpected<DETAIL::Plain<U>>::value>>
+		Expected(U&& value) : m_storage(std::in_place_index<0>, std::forward<U>(value)) {}
+
+		template <typename G>
+		Expected(const Unexpected<G>& u) : m_storage(std::in_place_index<1>, u.error()) {}
+
+		template <typename G>
+		Expected(Unexpected<G>&& u) : m_storage(std::in_place_index<1>, std::move(u).error()) {}
+
+		template <typename... Args>
+		explicit Expected(std::in_place_t, Args&&... args) : m_storage(std::in_place_index<0>, std::forward<Args>(args)...) {}
+
+		template <typename... Args>
+		explicit Expected(unexpect_t, Args&&... args) : m_storage(std::in_place_index<1>, std::forward<Args>(args)...) {}
+
+		bool has_value() const noexcept { return m_storage.has; }
+		explicit operator bool() const noexcept { return has_value(); }
+
+		// unchecked, like std::optional's
+		T& operator*() & noexcept { return m_storage.value; }
+		const T& operator*() const & noexcept { return m_storage.value; }
+		T&& operator*() && noexcept { return std::move(m_storage.value); }
+		T* operator->() noexcept { return &m_storage.value; }
+		const T* operator->() const noexcept { return &m_storage.value; }
+
+		// throws BadExpectedAccess<E> with a copy of the error
+		T& value() & { Check(); return **this; }
+		const T& value() const & { Check(); return **this; }
+		T&& value() && { Check(); return std::move(**this); }
+
+		E& error() & noexcept { return m_storage.error; }
+		const E& error() const & noexcept { return m_storage.error; }
+		E&& error() && noexcept { return std::move(m_storage.error); }
+
+		template <typename U>
+		T value_or(U&& otherwise) const & { return has_value() ? **this : static_cast<T>(std::forward<U>(otherwise)); }
+
+		template <typename U>
+		T value_or(U&& otherwise) && { return has_value() ? std::move(**this) : static_cast<T>(std::forward<U>(otherwise)); }
+
+		// f(value) -> Expected<U, E>, the error passes through
+		template <typename F> auto and_then(F&& f) & { return AndThen(*this, std::forward<F>(f)); }
+		template <typename F> auto and_then(F&& f) const & { return AndThen(*this, std::forward<F>(f)); }
+		template <typename F> auto and_then(F&& f) && { return AndThen(std::move(*this), std::forward<F>(f)); }
+
+		// f(value) -> U, wrapped as Expected<U, E>, the error passes through
+		template <typename F> auto transform(F&& f) & { return Transform(*this, std::forward<F>(f)); }
+		template <typename F> auto transform(F&& f) const & { return Transform(*this, std::forward<F>(f)); }
+		template <typename F> auto transform(F&& f) && { return Transform(std::move(*this), std::forward<F>(f)); }
+
+		// f(error) -> Expected<T, G>, the value passes through
+		template <typename F> auto or_else(F&& f) & { return OrElse(*this, std::forward<F>(f)); }
+		template <typename F> auto or_else(F&& f) const & { return OrElse(*this, std::forward<F>(f)); }
+		template <typename F> auto or_else(F&& f) && { return OrElse(std::move(*this), std::forward<F>(f)); }
+
+		// f(error) -> G, wrapped as Expected<T, G>, the value passes through
+		template <typename F> auto transform_error(F&& f) & { return TransformError(*this, std::forward<F>(f)); }
+		template <typename F> auto transform_error(F&& f) const & { return TransformError(*this, std::forward<F>(f)); }
+		template <typename F> auto transform_error(F&& f) && { return TransformError(std::move(*this), std::forward<F>(f)); }
+
+	private:
+
+		void Check() const
+		{
+			if (!has_value())
+				throw BadExpectedAccess<E>(error());
+		}
+
+		template <typename Self, typename F>
+		static auto AndThen(Self&& self, F&& f)
+		{
+			using R = DETAIL::Plain<std::invoke_result_t<F, decltype(*std::forward<Self>(self))>>;
+			static_assert(DETAIL::IsExpected<R>::value && std::is_same_v<typename R::error_type, E>, "and_then needs a function returning Expected<U, E>");
+			if (self.has_value())
+				return std::invoke(std::forward<F>(f), *std::forward<Self>(self));
+			return R(unexpect, std::forward<Self>(self).error());
+		}
+
+		template <typename Self, typename F>
+		static auto Transform(Self&& self, F&& f)
+		{
+			using U = std::remove_cv_t<std::invoke_result_t<F, decltype(*std::forward<Self>(self))>>;
+			if (self.has_value())
+				return DETAIL::Wrap<U, E>(std::forward<F>(f), *std::forward<Self>(self));
+			return Expected<U, E>(unexpect, std::forward<Self>(self).error());
+		}
+
+		template <typename Self, typename F>
+		static auto OrElse(Self&& self, F&& f)
+		{
+			using R = DETAIL::Plain<std::invoke_result_t<F, decltype(std::forward<Self>(self).error())>>;
+			static_assert(DETAIL::IsExpected<R>::value && std::is_same_v<typename R::value_type, T>, "or_else needs a function returning Expected<T, G>");
+			if (self.has_value())
+				return R(std::in_place, *std::forward<Self>(self));
+			return std::invoke(std::forward<F>(f), std::forward<Self>(self).error());
+		}
+
+		template <typename Self, typename F>
+		static auto TransformError(Self&& self, F&& f)
+		{
+			using G = std::remove_cv_t<std::invoke_result_t<F, decltype(std::forward<Self>(self).error())>>;
+			if (self.has_value())
+				return Expected<T, G>(std::in_place, *std::forward<Self>(self));
+			return Expected<T, G>(unexpect, std::invoke(std::forward<F>(f), std::forward<Self>(self).error()));
+		}
+
+		DETAIL::Storage<T, E> m_storage;		// by the flag, T and E may be the same type
+	};
+
+	// success carries nothing, only the error is stored
+	template <typename E>
+	class [[nodiscard]] Expected<void, E> {
+		static_assert(!std::is_reference_v<E>, "Expected holds values, not references");
+
+	public:
+
+		using value_type = void;
+		using error_type = E;
+		using unexpected_type = Unexpected<E>;
+
+		template <typename U>
+		using rebind = Expected<U, E>;
+
+		Expected() noexcept : m_storage(std::in_place_index<0>) {}
+
+		template <typename G>
+		Expected(const Unexpected<G>& u) : m_storage(std::in_place_index<1>, u.error()) {}
+
+		template <typename G>
+		Expected(Unexpected<G>&& u) : m_storage(std::in_place_index<1>, std::move(u).error()) {}
+
+		explicit Expected(std::in_place_t) noexcept : m_storage(std::in_place_index<0>) {}
+
+		template <typename... Args>
+		explicit Expected(unexpect_t, Args&&... args) : m_storage(std::in_place_index<1>, std::forward<Args>(args)...) {}
+
+		bool has_value() const noexcept { return m_storage.has; }
+		explicit operator bool() const noexcept { return has_value(); }
+
+		void operator*() const noexcept {}
+
+		void value() const &
+		{
+			if (!has_value())
+				throw BadExpectedAccess<E>(error());
+		}
+
+		void value() &&
+		{
+			if (!has_value())
+				throw BadExpectedAccess<E>(std::move(error()));
+		}
+
+		E& error() & noexcept { return m_storage.error; }
+		const E& error() const & noexcept { return m_storage.error; }
+		E&& error() && noexcept { return std::move(m_storage.error); }
+
+		// f() -> Expected<U, E>
+		template <typename F> auto and_then(F&& f) & { return AndThen(*this, std::forward<F>(f)); }
+		template <typename F> auto and_then(F&& f) const & { return AndThen(*this, std::forward<F>(f)); }
+		template <typename F> auto and_then(F&& f) && { return AndThen(std::move(*this), std::forward<F>(f)); }
+
+		// f() -> U, wrapped as Expected<U, E>
+		template <typename F> auto transform(F&& f) & { return Transform(*this, std::forward<F>(f)); }
+		template <typename F> auto transform(F&& f) const & { return Transform(*this, std::forward<F>(f)); }
+		template <typename F> auto transform(F&& f) && { return Transform(std::move(*this), std::forward<F>(f)); }
+
+		// f(error) -> Expected<void, G>
+		template <typename F> auto or_else(F&& f) & { return OrElse(*this, std::forward<F>(f)); }
+		template <typename F> auto or_else(F&& f) const & { return OrElse(*this, std::forward<F>(f)); }
+		template <typename F> auto or_else(F&& f) && { return OrElse(std::move(*this), std::forward<F>(f)); }
+
+		// f(error) -> G, wrapped as Expected<void, G>
+		template <typename F> auto transform_error(F&& f) & { return TransformError(*this, std::forward<F>(f)); }
+		template <typename F> auto transform_error(F&& f) const & { return TransformError(*this, std::forward<F>(f)); }
+		template <typename F> auto transform_error(F&& f) && { return TransformError(std::move(*this), std::forward<F>(f)); }
+
+	private:
+
+		template <typename Self, typename F>
+		static auto AndThen(Self&& self, F&& f)
+		{
+			using R = DETAIL::Plain<std::invoke_result_t<F>>;
+			static_assert(DETAIL::IsExpected<R>::value && std::is_same_v<typename R::error_type, E>, "and_then needs a function returning Expected<U, E>");
+			if (self.has_value())
+				return std::invoke(std::forward<F>(f));
+			return R(unexpect, std::forward<Self>(self).error());
+		}
+
+		template <typename Self, typename F>
+		static auto Transform(Self&& self, F&& f)
+		{
+			using U = std::remove_cv_t<std::invoke_result_t<F>>;
+			if (self.has_value())
+				return DETAIL::Wrap<U, E>(std::forward<F>(f));
+			return Expected<U, E>(unexpect, std::forward<Self>(self).error());
+		}
+
+		template <typename Self, typename F>
+		static auto OrElse(Self&& self, F&& f)
+		{
+			using R = DETAIL::Plain<std::invoke_result_t<F, decltype(std::forward<Self>(self).error())>>;
+			static_assert(DETAIL::IsExpected<R>::value && std::is_void_v<typename R::value_type>, "or_else needs a function returning Expected<void, G>");
+			if (self.has_value())
+				return R();
+			return std::invoke(std::forward<F>(f), std::forward<Self>(self).error());
+		}
+
+		template <typename Self, typename F>
+		static auto TransformError(Self&& self, F&& f)
+		{
+			using G = std::remove_cv_t<std::invoke_result_t<F, decltype(std::forward<Self>(self).error())>>;
+			if (self.has_value())
+				return Expected<void, G>();
+			return Expected<void, G>(unexpect, std::invoke(std::forward<F>(f), std::forward<Self>(self).error()));
+		}
+
+		DETAIL::Storage<DETAIL::Empty, E> m_storage;
+	};
+
+	// f(args...) with what it throws caught as the error, for calling code that reports failures by throwing
+	template <typename F, typename... Args>
+	auto Catching(F&& f, Args&&... args) noexcept -> Expected<std::invoke_result_t<F, Args...>, std::exception_ptr>
+	{
+		using R = std::invoke_result_t<F, Args...>;
+		try
+		{
+			return DETAIL::Wrap<R, std::exception_ptr>(std::forward<F>(f), std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			return Unexpected(std::current_exception());
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,571 @@
+#pragma once
+
+#ifndef __MODERN_CPP_FLAT_HASH_MAP_H
+#define __MODERN_CPP_FLAT_HASH_MAP_H
+
+#include "Simd.h"
+#include "Transparent.h"
+
+#include <tuple>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <memory_resource>
+#include <initializer_list>
+
+// SSE2 is part of x86-64, the group probe needs no runtime dispatch there
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MODERNCPP_FLAT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Open addressing hash map in the Swiss table layout: one control byte per slot, holding 7 bits of
+// the hash, so one SSE2 compare checks 16 slots at once and keys are only compared on a likely hit.
+// Keys and values sit inline in a single flat array, no allocation per entry.
+// https://abseil.io/about/design/swisstables
+
+namespace MODERNCPP
+{
+	// std::hash, plus transparent string hashing, so lookups by string_view or literal build no std::string
+	template <typename K>
+	struct FlatHash : std::hash<K> {};
+
+	template <typename Alloc>
+	struct FlatHash<std::basic_string<char, std::char_traits<char>, Alloc>> : StringHash {};		// std::string, std::pmr::string
+
+	// == of its own, except that strings compare as string_view, whatever their allocator
+	template <typename K>
+	struct FlatEq : std::equal_to<> {};
+
+	template <typename Alloc>
+	struct FlatEq<std::basic_string<char, std::char_traits<char>, Alloc>> : StringEqual {};
+
+	// Unordered map with the usual interface. Differences from std::unordered_map: insertions
+	// may move elements and invalidate iterators and references, there are no buckets or nodes.
+	template <typename K, typename V, typename Hash = FlatHash<K>, typename Eq = FlatEq<K>, typename Alloc = std::allocator<std::pair<const K, V>>>
+	class FlatHashMap {
+
+		template <typename T, typename = void> struct IsTransparent : std::false_type {};
+		template <typename T> struct IsTransparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+		// lookups by anything the hasher and comparer accept as they are, others go through K
+		static constexpr bool transparent = IsTransparent<Hash>::value && IsTransparent<Eq>::value;
+
+		using ctrl_t = std::int8_t;
+
+		static constexpr ctrl_t ctrl_empty = -128;			// 0b10000000
+		static constexpr ctrl_t ctrl_deleted = -2;			// 0b11111110, full slots are 0b0hhhhhhh
+		static constexpr std::size_t group_width = 16;
+		static constexpr std::size_t npos = ~std::size_t(0);
+
+		using Traits = std::allocator_traits<Alloc>;
+		using CtrlAlloc = typename Traits::template rebind_alloc<ctrl_t>;
+
+	public:
+
+		using key_type = K;
+		using mapped_type = V;
+		using value_type = std::pair<const K, V>;
+		using size_type = std::size_t;
+		using hasher = Hash;
+		using key_equal = Eq;
+		using allocator_type = Alloc;
+
+		template <bool Const>
+		class Iterator {
+		public:
+
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = FlatHashMap::value_type;
+			using difference_type = std::ptrdiff_t;
+			using reference = std::conditional_t<Const, const value_type&, value_type&>;
+			using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+			Iterator() = default;
+			template <bool C = Const, typename = std::enable_if_t<C>>
+			Iterator(const Iterator<false>& other) : m_ctrl(other.m_ctrl), m_end(other.m_end), m_slot(other.m_slot) {}
+
+			reference operator*() const { return *m_slot; }
+			pointer operator->() const { return m_slot; }
+
+			Iterator& operator++() { ++m_ctrl; ++m_slot; SkipFree(); return *this; }
+			Iterator operator++(int) { Iterator i = *this; ++*this; return i; }
+
+			friend bool operator==(const Iterator& a, const Iterator& b) { return a.m_ctrl == b.m_ctrl; }
+			friend bool operator!=(const Iterator& a, const Iterator& b) { return a.m_ctrl != b.m_ctrl; }
+
+		private:
+
+			friend class FlatHashMap;
+			template <bool> friend class Iterator;
+
+			Iterator(const ctrl_t* ctrl, const ctrl_t* end, pointer slot) : m_ctrl(ctrl), m_end(end), m_slot(slot) {}
+
+			void SkipFree() { while (m_ctrl != m_end && *m_ctrl < 0) { ++m_ctrl; ++m_slot; } }
+
+			const ctrl_t* m_ctrl = nullptr;
+			const ctrl_t* m_end = nullptr;
+			pointer m_slot = nullptr;
+		};
+
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		FlatHashMap() = default;
+		explicit FlatHashMap(const Alloc& alloc) noexcept : m_alloc(alloc) {}
+		explicit FlatHashMap(size_type capacity, const Hash& hash = Hash(), const Eq& eq = Eq(), const Alloc& alloc = Alloc())
+			: m_hash(hash), m_eq(eq), m_alloc(alloc) { reserve(capacity); }
+
+		FlatHashMap(std::initializer_list<value_type> init, const Alloc& alloc = Alloc()) : m_alloc(alloc)
+		{
+			reserve(init.size());
+			for (const value_type& v : init)
+				insert(v);
+		}
+
+		FlatHashMap(const FlatHashMap& other) : FlatHashMap(other, Traits::select_on_container_copy_construction(other.m_alloc)) {}
+		FlatHashMap(const FlatHashMap& other, const Alloc& alloc) : m_hash(other.m_hash), m_eq(other.m_eq), m_alloc(alloc)
+		{
+			reserve(other.size());
+			for (const value_type& v : other)
+				insert(v);
+		}
+
+		FlatHashMap(FlatHashMap&& other) noexcept : m_hash(std::move(other.m_hash)), m_eq(std::move(other.m_eq)), m_alloc(std::move(other.m_alloc)) { Steal(other); }
+
+		// another allocator can not free the table, the elements move one by one then
+		FlatHashMap(FlatHashMap&& other, const Alloc& alloc) : m_hash(std::move(other.m_hash)), m_eq(std::move(other.m_eq)), m_alloc(alloc)
+		{
+			if (m_alloc == other.m_alloc)
+				Steal(other);
+			else
+				MoveElements(other);
+		}
+
+		// keeps its allocator unless the allocator says it propagates
+		FlatHashMap& operator=(const FlatHashMap& other)
+		{
+			if (this != &other)
+			{
+				if constexpr (Traits::propagate_on_container_copy_assignment::value)
+				{
+					Release();
+					m_alloc = other.m_alloc;
+				}
+				FlatHashMap copy(other, m_alloc);
+				swap(copy);
+			}
+			return *this;
+		}
+
+		FlatHashMap& operator=(FlatHashMap&& other) noexcept(Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value)
+		{
+			if (this != &other)
+			{
+				Release();
+				m_hash = std::move(other.m_hash);
+				m_eq = std::move(other.m_eq);
+				if constexpr (Traits::propagate_on_container_move_assignment::value)
+					m_alloc = std::move(other.m_alloc);
+				if (Traits::is_always_equal::value || m_alloc == other.m_alloc)
+					Steal(other);
+				else
+					MoveElements(other);		// std::pmr: the allocator stays, only the elements move
+			}
+			return *this;
+		}
+
+		~FlatHashMap() { Release(); }
+
+		// allocators that do not propagate on swap must be equal
+		void swap(FlatHashMap& other) noexcept
+		{
+			using std::swap;
+			swap(m_hash, other.m_hash);
+			swap(m_eq, other.m_eq);
+			if constexpr (Traits::propagate_on_container_swap::value)
+				swap(m_alloc, other.m_alloc);
+			swap(m_ctrl, other.m_ctrl);
+			swap(m_slots, other.m_slots);
+			swap(m_capacity, other.m_capacity);
+			swap(m_size, other.m_size);
+			swap(m_growthLeft, other.m_growthLeft);
+		}
+
+		iterator begin() { iterator i(m_ctrl, m_ctrl + m_capacity, m_slots); i.SkipFree(); return i; }
+		iterator end() { return iterator(m_ctrl + m_capacity, m_ctrl + m_capacity, m_slots + m_capacity); }
+		const_iterator begin() const { const_iterator i(m_ctrl, m_ctrl + m_capacity, m_slots); i.SkipFree(); return i; }
+		const_iterator end() const { return const_iterator(m_ctrl + m_capacity, m_ctrl + m_capacity, m_slots + m_capacity); }
+		const_iterator cbegin() const { return begin(); }
+		const_iterator cend() const { return end(); }
+
+		bool empty() const { return m_size == 0; }
+		size_type size() const { return m_size; }
+		size_type capacity() const { return m_capacity; }			// slots, a power of two
+		float load_factor() const { return m_capacity ? float(m_size) / float(m_capacity) : 0.0f; }
+		static constexpr float max_load_factor() { return 0.875f; }
+
+		// room for count elements without another rehash
+		void reserve(size_type count)
+		{
+			if (count > MaxSize(m_capacity))
+				Rehash(CapacityFor(count));
+		}
+
+		// at least count slots and enough for the current elements, also drops all tombstones
+		void rehash(size_type count)
+		{
+			size_type capacity = CapacityFor(m_size);
+			while (capacity < count)
+				capacity *= 2;
+			if (capacity != m_capacity || m_growthLeft != MaxSize(m_capacity) - m_size)
+				Rehash(m_size || count ? capacity : 0);
+		}
+
+		void clear()
+		{
+			DestroyAll();
+			if (m_capacity)
+				std::memset(m_ctrl, ctrl_empty, m_capacity);
+			m_size = 0;
+			m_growthLeft = MaxSize(m_capacity);
+		}
+
+		template <typename Q = K>
+		iterator find(const Q& key) { return IteratorAt(FindIndex(AsKey(key))); }
+		template <typename Q = K>
+		const_iterator find(const Q& key) const { return IteratorAt(FindIndex(AsKey(key))); }
+
+		template <typename Q = K>
+		bool contains(const Q& key) const { return FindIndex(AsKey(key)) != npos; }
+		template <typename Q = K>
+		size_type count(const Q& key) const { return contains(key) ? 1 : 0; }
+
+		template <typename Q = K>
+		V& at(const Q& key) { return const_cast<V&>(static_cast<const FlatHashMap&>(*this).at(key)); }
+		template <typename Q = K>
+		const V& at(const Q& key) const
+		{
+			const size_type i = FindIndex(AsKey(key));
+			if (i == npos)
+				throw std::out_of_range("FlatHashMap::at");
+			return m_slots[i].second;
+		}
+
+		// builds the key only when it has to be inserted, u["RED"] allocates nothing for a present key
+		template <typename Q = K>
+		V& operator[](Q&& key)
+		{
+			return EmplaceKey(AsKey(key), std::piecewise_construct,
+				std::forward_as_tuple(std::forward<Q>(key)), std::tuple<>()).first->second;
+		}
+
+		template <typename Q = K, typename... Args>
+		std::pair<iterator, bool> try_emplace(Q&& key, Args&&... args)
+		{
+			return EmplaceKey(AsKey(key), std::piecewise_construct,
+				std::forward_as_tuple(std::forward<Q>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+		}
+
+		template <typename Q = K, typename M>
+		std::pair<iterator, bool> insert_or_assign(Q&& key, M&& value)
+		{
+			auto r = try_emplace(std::forward<Q>(key), std::forward<M>(value));
+			if (!r.second)
+				r.first->second = std::forward<M>(value);
+			return r;
+		}
+
+		std::pair<iterator, bool> insert(const value_type& v) { return EmplaceKey(v.first, v); }
+		std::pair<iterator, bool> insert(value_type&& v) { return EmplaceKey(v.first, std::move(v)); }
+
+		template <typename... Args>
+		std::pair<iterator, bool> emplace(Args&&... args)
+		{
+			// the key is only known once the pair exists
+			value_type v(std::forward<Args>(args)...);
+			return EmplaceKey(v.first, std::move(v));
+		}
+
+		template <typename Q = K>
+		size_type erase(const Q& key)
+		{
+			const size_type i = FindIndex(AsKey(key));
+			if (i == npos)
+				return 0;
+			EraseAt(i);
+			return 1;
+		}
+
+		// erasing never moves other elements, the returned iterator is the next one
+		iterator erase(const_iterator pos)
+		{
+			const size_type i = static_cast<size_type>(pos.m_ctrl - m_ctrl);
+			EraseAt(i);
+			iterator next(m_ctrl + i, m_ctrl + m_capacity, m_slots + i);
+			next.SkipFree();
+			return next;
+		}
+		iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+		hasher hash_function() const { return m_hash; }
+		key_equal key_eq() const { return m_eq; }
+		allocator_type get_allocator() const { return m_alloc; }
+
+	private:
+
+		// 16 control bytes, matched all at once
+		struct Group {
+#if defined(MODERNCPP_FLAT_SSE2)
+			explicit Group(const ctrl_t* p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+			std::uint32_t Match(ctrl_t h2) const { return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))); }
+			std::uint32_t MatchEmpty() const { return Match(ctrl_empty); }
+			std::uint32_t MatchFree() const { return static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl)); }	// empty or deleted, sign bit set
+
+			__m128i ctrl;
+#else
+			explicit Group(const ctrl_t* p) { std::memcpy(ctrl, p, group_width); }
+
+			std::uint32_t Match(ctrl_t h2) const
+			{
+				std::uint32_t mask = 0;
+				for (std::size_t i = 0; i < group_width; ++i)
+					mask |= std::uint32_t(ctrl[i] == h2) << i;
+				return mask;
+			}
+			std::uint32_t MatchEmpty() const { return Match(ctrl_empty); }
+			std::uint32_t MatchFree() const
+			{
+				std::uint32_t mask = 0;
+				for (std::size_t i = 0; i < group_width; ++i)
+					mask |= std::uint32_t(ctrl[i] < 0) << i;
+				return mask;
+			}
+
+			ctrl_t ctrl[group_width];
+#endif
+		};
+
+		static std::size_t LowestBit(std::uint32_t mask)
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long i;
+			_BitScanForward(&i, mask);
+			return i;
+#else
+			return static_cast<std::size_t>(__builtin_ctz(mask));
+#endif
+		}
+
+		// 7/8 of the slots may be used, so every probe sequence meets an empty slot
+		static size_type MaxSize(size_type capacity) { return capacity - capacity / 8; }
+
+		static size_type CapacityFor(size_type count)
+		{
+			size_type capacity = group_width;
+			while (MaxSize(capacity) < count)
+				capacity *= 2;
+			return capacity;
+		}
+
+		template <typename Q>
+		static decltype(auto) AsKey(const Q& key)
+		{
+			if constexpr (transparent || std::is_same<Q, K>::value)
+				return (key);
+			else
+				return K(key);
+		}
+
+		// std::hash of an integer is often the integer itself, spread it over all 64 bits first
+		template <typename Q>
+		std::uint64_t HashOf(const Q& key) const
+		{
+			std::uint64_t h = static_cast<std::uint64_t>(m_hash(key)) * 0x9E3779B97F4A7C15ull;
+			return h ^ (h >> 32);
+		}
+
+		static ctrl_t H2(std::uint64_t h) { return static_cast<ctrl_t>(h & 0x7F); }
+
+		// triangular probing over whole groups, visits every group once as their count is a power of two
+		template <typename Q>
+		size_type FindIndex(const Q& key, std::uint64_t h) const
+		{
+			if (!m_capacity)
+				return npos;
+			const size_type mask = m_capacity / group_width - 1;
+			size_type g = static_cast<size_type>(h >> 7) & mask;
+			for (size_type step = 1; ; ++step)
+			{
+				const Group group(m_ctrl + g * group_width);
+				for (std::uint32_t m = group.Match(H2(h)); m; m &= m - 1)
+				{
+					const size_type i = g * group_width + LowestBit(m);
+					if (m_eq(m_slots[i].first, key))
+						return i;
+				}
+				if (group.MatchEmpty())
+					return npos;
+				g = (g + step) & mask;
+			}
+		}
+
+		template <typename Q>
+		size_type FindIndex(const Q& key) const { return FindIndex(key, HashOf(key)); }
+
+		size_type FindFree(std::uint64_t h) const
+		{
+			const size_type mask = m_capacity / group_width - 1;
+			size_type g = static_cast<size_type>(h >> 7) & mask;
+			for (size_type step = 1; ; ++step)
+			{
+				if (const std::uint32_t m = Group(m_ctrl + g * group_width).MatchFree())
+					return g * group_width + LowestBit(m);
+				g = (g + step) & mask;
+			}
+		}
+
+		template <typename Q, typename... Args>
+		std::pair<iterator, bool> EmplaceKey(const Q& key, Args&&... args)
+		{
+			const std::uint64_t h = HashOf(key);
+			size_type i = FindIndex(key, h);
+			if (i != npos)
+				return { IteratorAt(i), false };
+
+			if (m_growthLeft == 0)
+			{
+				// mostly tombstones: clean up in place, otherwise double
+				Rehash(m_size < MaxSize(m_capacity) / 2 ? m_capacity : CapacityFor(m_capacity));
+			}
+
+			i = FindFree(h);
+			Traits::construct(m_alloc, m_slots + i, std::forward<Args>(args)...);
+			if (m_ctrl[i] == ctrl_empty)
+				--m_growthLeft;
+			m_ctrl[i] = H2(h);
+			++m_size;
+			return { IteratorAt(i), true };
+		}
+
+		// a group with an empty slot was never full, so no probe went past it: the slot may
+		// become empty again. Otherwise it turns into a tombstone that keeps the probes going.
+		void EraseAt(size_type i)
+		{
+			Traits::destroy(m_alloc, m_slots + i);
+			--m_size;
+			if (Group(m_ctrl + (i & ~(group_width - 1))).MatchEmpty())
+			{
+				m_ctrl[i] = ctrl_empty;
+				++m_growthLeft;
+			}
+			else
+				m_ctrl[i] = ctrl_deleted;
+		}
+
+		void Rehash(size_type capacity)
+		{
+			ctrl_t* oldCtrl = m_ctrl;
+			value_type* oldSlots = m_slots;
+			const size_type oldCapacity = m_capacity;
+
+			m_ctrl = capacity ? CtrlAlloc(m_alloc).allocate(capacity) : nullptr;
+			m_slots = capacity ? Traits::allocate(m_alloc, capacity) : nullptr;
+			m_capacity = capacity;
+			m_growthLeft = MaxSize(capacity) - m_size;
+			if (capacity)
+				std::memset(m_ctrl, ctrl_empty, capacity);
+
+			for (size_type i = 0; i < oldCapacity; ++i)
+			{
+				if (oldCtrl[i] < 0)
+					continue;
+				value_type& v = oldSlots[i];
+				const std::uint64_t h = HashOf(v.first);
+				const size_type j = FindFree(h);
+				// the old slot is destroyed right after, its key may be moved from like a node handle's
+				Traits::construct(m_alloc, m_slots + j, std::move(const_cast<K&>(v.first)), std::move(v.second));
+				m_ctrl[j] = H2(h);
+				Traits::destroy(m_alloc, &v);
+			}
+
+			if (oldCapacity)
+			{
+				CtrlAlloc(m_alloc).deallocate(oldCtrl, oldCapacity);
+				Traits::deallocate(m_alloc, oldSlots, oldCapacity);
+			}
+		}
+
+		void DestroyAll()
+		{
+			if (!std::is_trivially_destructible<value_type>::value)
+				for (size_type i = 0; i < m_capacity; ++i)
+					if (m_ctrl[i] >= 0)
+						Traits::destroy(m_alloc, m_slots + i);
+		}
+
+		void Release()
+		{
+			DestroyAll();
+			if (m_capacity)
+			{
+				CtrlAlloc(m_alloc).deallocate(m_ctrl, m_capacity);
+				Traits::deallocate(m_alloc, m_slots, m_capacity);
+			}
+			m_ctrl = nullptr;
+			m_slots = nullptr;
+			m_capacity = m_size = m_growthLeft = 0;
+		}
+
+		void Steal(FlatHashMap& other)
+		{
+			m_ctrl = std::exchange(other.m_ctrl, nullptr);
+			m_slots = std::exchange(other.m_slots, nullptr);
+			m_capacity = std::exchange(other.m_capacity, 0);
+			m_size = std::exchange(other.m_size, 0);
+			m_growthLeft = std::exchange(other.m_growthLeft, 0);
+		}
+
+		void MoveElements(FlatHashMap& other)
+		{
+			reserve(other.size());
+			for (value_type& v : other)
+				EmplaceKey(v.first, std::move(const_cast<K&>(v.first)), std::move(v.second));
+			other.Release();
+		}
+
+		iterator IteratorAt(size_type i) { return i == npos ? end() : iterator(m_ctrl + i, m_ctrl + m_capacity, m_slots + i); }
+		const_iterator IteratorAt(size_type i) const { return i == npos ? end() : const_iterator(m_ctrl + i, m_ctrl + m_capacity, m_slots + i); }
+
+		Hash m_hash;
+		Eq m_eq;
+		Alloc m_alloc;
+		ctrl_t* m_ctrl = nullptr;
+		value_type* m_slots = nullptr;
+		size_type m_capacity = 0;
+		size_type m_size = 0;
+		size_type m_growthLeft = 0;
+	};
+
+	namespace PMR
+	{
+		// like std::pmr::unordered_map, the table and the elements come from one memory resource
+		template <typename K, typename V, typename Hash = FlatHash<K>, typename Eq = FlatEq<K>>
+		using FlatHashMap = MODERNCPP::FlatHashMap<K, V, Hash, Eq, std::pmr::polymorphic_allocator<std::pair<const K, V>>>;
+	}
+}
+
+#endif
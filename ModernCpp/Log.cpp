@@ -0,0 +1,257 @@
+#include "pch.h"
+#include "Log.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#if !defined(_WIN32)
+#include <limits.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+namespace MODERNCPP
+{
+	namespace
+	{
+		// most records the writer takes at once
+		const std::size_t max_batch = 1024;
+
+		// most iovecs one writev takes
+#if defined(IOV_MAX)
+		const std::size_t max_iov = IOV_MAX < 1024 ? IOV_MAX : 1024;
+#else
+		const std::size_t max_iov = 1024;
+#endif
+	}
+
+	LogSink& LogSink::Instance()
+	{
+		// deliberately leaked, the writer may still be draining while other statics are destroyed
+		static LogSink* sink = [] {
+			LogSink* s = new LogSink();
+			// thread_locals are gone by then, main's buffer was committed when they were destroyed
+			std::atexit([] { LogSink::Instance().Drain(); });
+			return s;
+		}();
+		return *sink;
+	}
+
+	LogSink::LogSink()
+	{
+		m_writer = std::thread([this] { WriterLoop(); });
+		m_writer.detach();
+	}
+
+	LogBlock* LogSink::Acquire(std::size_t capacity)
+	{
+		LogBlock* block;
+		if (capacity <= LogBlock::default_capacity && m_free.try_pop(block))
+			return block;
+		return new LogBlock((std::max)(capacity, LogBlock::default_capacity));
+	}
+
+	void LogSink::Submit(const LogRecord& record)
+	{
+		// the writer is far behind, wait for it rather than grow without bound
+		while (!m_queue.try_push(record))
+		{
+			m_wake.notify_one();
+			std::this_thread::yield();
+		}
+		m_submitted.fetch_add(1, std::memory_order_seq_cst);
+
+		if (m_idle.load(std::memory_order_seq_cst))
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_wake.notify_one();
+		}
+	}
+
+	void LogSink::Flush()
+	{
+		LogBuffer::Local().Commit();
+		Drain();
+	}
+
+	void LogSink::Drain()
+	{
+		const std::uint64_t target = m_submitted.load(std::memory_order_seq_cst);
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wake.notify_one();
+		m_drained.wait(lock, [this, target] { return m_written.load(std::memory_order_acquire) >= target; });
+	}
+
+	void LogSink::WriterLoop()
+	{
+		std::unique_ptr<LogRecord[]> batch(new LogRecord[max_batch]);
+		bool napped = false;
+		for (;;)
+		{
+			const std::size_t n = m_queue.pop_bulk(batch.get(), max_batch);
+			if (n == 0)
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				if (!napped)
+				{
+					// a short nap nobody has to wake us from, a burst of records costs Submit no system call
+					m_wake.wait_for(lock, std::chrono::milliseconds(1));
+					napped = true;
+					continue;
+				}
+
+				// announce the long sleep first, then look again, so a Submit in between is never missed
+				m_idle.store(true, std::memory_order_seq_cst);
+				if (m_queue.size() == 0)
+					m_wake.wait_for(lock, std::chrono::milliseconds(50));
+				m_idle.store(false, std::memory_order_relaxed);
+				continue;
+			}
+			napped = false;
+
+			Write(batch.get(), n);
+
+			// every record of a retired block is written by now
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				LogBlock* block = batch[i].retire;
+				if (block && (block->capacity != LogBlock::default_capacity || !m_free.try_push(block)))
+					delete block;
+			}
+
+			m_written.fetch_add(n, std::memory_order_release);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_drained.notify_all();
+		}
+	}
+
+	// no flush per line: one system call for the whole batch
+	void LogSink::Write(const LogRecord* records, std::size_t n)
+	{
+#if defined(_WIN32)
+		for (std::size_t i = 0; i < n; ++i)
+			if (records[i].size)
+				std::fwrite(records[i].data, 1, records[i].size, stdout);
+		std::fflush(stdout);
+#else
+		iovec iov[max_iov];
+		std::size_t i = 0;
+		while (i < n)
+		{
+			// records a thread committed back to back sit next to each other in its block
+			std::size_t count = 0;
+			for (; i < n && count < max_iov; ++i)
+			{
+				const LogRecord& r = records[i];
+				if (!r.size)
+					continue;
+				if (count && static_cast<char*>(iov[count - 1].iov_base) + iov[count - 1].iov_len == r.data)
+					iov[count - 1].iov_len += r.size;
+				else
+				{
+					iov[count].iov_base = const_cast<char*>(r.data);
+					iov[count].iov_len = r.size;
+					++count;
+				}
+			}
+
+			iovec* next = iov;
+			while (count)
+			{
+				const ssize_t written = ::writev(STDOUT_FILENO, next, static_cast<int>(count));
+				if (written < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					return;							// stdout is gone, drop the batch
+				}
+
+				// partial write, skip what made it and retry the rest
+				std::size_t done = static_cast<std::size_t>(written);
+				while (count && done >= next->iov_len)
+				{
+					done -= next->iov_len;
+					++next;
+					--count;
+				}
+				if (count)
+				{
+					next->iov_base = static_cast<char*>(next->iov_base) + done;
+					next->iov_len -= done;
+				}
+			}
+		}
+#endif
+	}
+
+	LogBuffer& LogBuffer::Local()
+	{
+		thread_local LogBuffer buffer;
+		return buffer;
+	}
+
+	LogBuffer::~LogBuffer()
+	{
+		Commit();
+		Retire();
+	}
+
+	void LogBuffer::Commit()
+	{
+		if (pptr() == pbase())
+			return;
+		LogSink::Instance().Submit({ pbase(), static_cast<std::size_t>(pptr() - pbase()), nullptr });
+		// the next record starts right behind this one
+		setp(pptr(), epptr());
+	}
+
+	void LogBuffer::Retire()
+	{
+		if (m_block)
+			LogSink::Instance().Submit({ nullptr, 0, m_block });
+		m_block = nullptr;
+		setp(nullptr, nullptr);
+	}
+
+	LogBuffer::int_type LogBuffer::overflow(int_type c)
+	{
+		// the block is full or there is none yet: move the record started so far to a fresh one
+		const std::size_t pending = static_cast<std::size_t>(pptr() - pbase());
+		LogBlock* block = LogSink::Instance().Acquire(2 * pending + 1);
+		if (pending)
+			std::memcpy(block->data.get(), pbase(), pending);
+		Retire();
+
+		m_block = block;
+		setp(block->data.get(), block->data.get() + block->capacity);
+		pbump(static_cast<int>(pending));
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+			sputc(traits_type::to_char_type(c));
+		return traits_type::not_eof(c);
+	}
+
+	std::streamsize LogBuffer::xsputn(const char* s, std::streamsize n)
+	{
+		std::streamsize done = 0;
+		while (done < n)
+		{
+			if (pptr() == epptr())
+				overflow(traits_type::eof());
+			const std::streamsize room = (std::min)(n - done, static_cast<std::streamsize>(epptr() - pptr()));
+			std::memcpy(pptr(), s + done, static_cast<std::size_t>(room));
+			pbump(static_cast<int>(room));
+			done += room;
+		}
+		return n;
+	}
+
+	std::ostream& LogLine::LocalStream()
+	{
+		thread_local std::ostream os(&LogBuffer::Local());
+		return os;
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#ifndef __MODERN_CPP_LOG_H
+#define __MODERN_CPP_LOG_H
+
+#include "RingBuffer.h"
+
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <condition_variable>
+
+// Asynchronous console sink: every thread formats into its own block, each finished record goes to
+// a writer thread as a (pointer, length) descriptor through a lock-free queue, and the writer hands
+// whole batches of them to stdout, one writev per batch, neighbouring records merged into one iovec.
+//
+//   Log() << "x = " << x << '\n';		// one record, committed at the end of the statement
+//   LogSink::Instance().Flush();		// wait until everything logged so far is written
+
+namespace MODERNCPP
+{
+	// Memory records are formatted into, owned by one thread until the writer retires it
+	struct LogBlock {
+		static constexpr std::size_t default_capacity = 64 * 1024;
+
+		explicit LogBlock(std::size_t capacity) : capacity(capacity), data(new char[capacity]) {}
+
+		std::size_t capacity;
+		std::unique_ptr<char[]> data;
+	};
+
+	// A committed record, or with retire set, the note that no more records come from that block
+	struct LogRecord {
+		const char* data;
+		std::size_t size;
+		LogBlock* retire;
+	};
+
+	class LogSink {
+	public:
+
+		// lives until the process ends, so threads may log from anywhere, even while statics unwind
+		static LogSink& Instance();
+
+		LogSink(const LogSink&) = delete;
+		LogSink& operator=(const LogSink&) = delete;
+
+		// blocks until every record committed so far, the caller's pending one included, is written
+		void Flush();
+
+		LogBlock* Acquire(std::size_t capacity);
+		void Submit(const LogRecord& record);
+
+	private:
+
+		LogSink();
+
+		void Drain();						// Flush without touching the caller's buffer
+		void WriterLoop();
+		void Write(const LogRecord* records, std::size_t n);
+
+		MpmcRingBuffer<LogRecord> m_queue{ 8192 };			// committed records, in commit order
+		MpmcRingBuffer<LogBlock*> m_free{ 64 };				// retired blocks, ready for reuse
+
+		alignas(cache_line_size) std::atomic<std::uint64_t> m_submitted{ 0 };
+		alignas(cache_line_size) std::atomic<std::uint64_t> m_written{ 0 };
+		std::atomic<bool> m_idle{ false };
+
+		// only touched when the writer has nothing to do or somebody waits for a flush
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_drained;
+
+		std::thread m_writer;
+	};
+
+	// The calling thread's buffer, a streambuf over the free end of its block. Records are packed
+	// one after the other, so logging touches a few hot cache lines instead of a fresh buffer each time.
+	class LogBuffer : public std::streambuf {
+	public:
+
+		static LogBuffer& Local();
+
+		LogBuffer() = default;
+		~LogBuffer() override;
+
+		// hands what was written since the last commit to the sink
+		void Commit();
+
+	protected:
+
+		int_type overflow(int_type c) override;
+		std::streamsize xsputn(const char* s, std::streamsize n) override;
+		int sync() override { Commit(); return 0; }			// std::endl and flush() commit, never block
+
+	private:
+
+		void Retire();
+
+		LogBlock* m_block = nullptr;
+	};
+
+	// One statement's worth of output, committed as a whole so records of different threads never interleave
+	class LogLine {
+	public:
+
+		LogLine() : m_os(LocalStream()) {}
+		~LogLine() { static_cast<LogBuffer*>(m_os.rdbuf())->Commit(); }
+
+		LogLine(const LogLine&) = delete;
+		LogLine& operator=(const LogLine&) = delete;
+
+		template <typename T>
+		LogLine& operator<<(const T& value)
+		{
+			m_os << value;
+			return *this;
+		}
+
+		LogLine& operator<<(std::ostream& (*manip)(std::ostream&))
+		{
+			manip(m_os);
+			return *this;
+		}
+
+		std::ostream& stream() { return m_os; }
+
+	private:
+
+		// formatting state (boolalpha, precision, ...) sticks per thread, like it would on std::cout
+		static std::ostream& LocalStream();
+
+		std::ostream& m_os;
+	};
+
+	inline LogLine Log() { return LogLine(); }
+}
+
+#endif
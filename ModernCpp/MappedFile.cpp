@@ -0,0 +1,187 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#include <utility>
+#include <algorithm>
+#include <system_error>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace MODERNCPP
+{
+	namespace
+	{
+		namespace fs = std::filesystem;
+
+		[[noreturn]] void Fail(const fs::path& path, int error)
+		{
+#if defined(_WIN32)
+			throw fs::filesystem_error("MappedFile", path, std::error_code(error, std::system_category()));
+#else
+			throw fs::filesystem_error("MappedFile", path, std::error_code(error, std::generic_category()));
+#endif
+		}
+	}
+
+#if defined(_WIN32)
+	MappedFile::MappedFile(const fs::path& path, Access access)
+	{
+		const DWORD hint = access == Access::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN
+			: access == Access::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL;
+		const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, hint, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			Fail(path, GetLastError());
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+		{
+			const DWORD error = GetLastError();
+			CloseHandle(file);
+			Fail(path, error);
+		}
+		if (size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return;
+		}
+
+		// the view keeps the mapping and the file open
+		m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const DWORD error = GetLastError();
+		CloseHandle(file);
+		if (m_mapping == nullptr)
+			Fail(path, error);
+
+		m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		if (m_data == nullptr)
+		{
+			const DWORD error = GetLastError();
+			CloseHandle(m_mapping);
+			m_mapping = nullptr;
+			Fail(path, error);
+		}
+		m_size = static_cast<std::size_t>(size.QuadPart);
+	}
+
+	void MappedFile::Unmap() noexcept
+	{
+		if (m_data)
+			UnmapViewOfFile(m_data);
+		if (m_mapping)
+			CloseHandle(m_mapping);
+		m_data = nullptr;
+		m_size = 0;
+		m_mapping = nullptr;
+	}
+
+	void MappedFile::prefetch(std::size_t, std::size_t) const noexcept {}
+	void MappedFile::release(std::size_t, std::size_t) const noexcept {}
+#else
+	MappedFile::MappedFile(const fs::path& path, Access access)
+	{
+		const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			Fail(path, errno);
+
+		struct stat st;
+		if (fstat(fd, &st) != 0)
+		{
+			const int error = errno;
+			close(fd);
+			Fail(path, error);
+		}
+		if (st.st_size == 0)
+		{
+			close(fd);
+			return;
+		}
+
+		// the mapping keeps the file open
+		void* data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		const int error = errno;
+		close(fd);
+		if (data == MAP_FAILED)
+			Fail(path, error);
+
+		m_data = static_cast<const char*>(data);
+		m_size = static_cast<std::size_t>(st.st_size);
+
+		// Sequential doubles the read ahead and lets the kernel drop pages behind the scan early
+		const int advice = access == Access::Sequential ? MADV_SEQUENTIAL
+			: access == Access::Random ? MADV_RANDOM : MADV_NORMAL;
+		madvise(data, m_size, advice);
+	}
+
+	void MappedFile::Unmap() noexcept
+	{
+		if (m_data)
+			munmap(const_cast<char*>(m_data), m_size);
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	namespace
+	{
+		// madvise works on whole pages: outward grows the range to the pages it touches, otherwise it
+		// shrinks to the pages it covers, a neighbour's bytes on a shared page are left alone
+		void Advise(const char* data, std::size_t size, std::size_t offset, std::size_t length, int advice, bool outward)
+		{
+			if (data == nullptr || offset >= size)
+				return;
+			static const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+			const std::size_t end = offset + (std::min)(length, size - offset);
+			const std::size_t first = outward ? offset / page * page : (offset + page - 1) / page * page;
+			const std::size_t last = outward || end == size ? end : end / page * page;
+			if (first < last)
+				madvise(const_cast<char*>(data) + first, last - first, advice);
+		}
+	}
+
+	void MappedFile::prefetch(std::size_t offset, std::size_t length) const noexcept
+	{
+		Advise(m_data, m_size, offset, length, MADV_WILLNEED, true);
+	}
+
+	void MappedFile::release(std::size_t offset, std::size_t length) const noexcept
+	{
+		Advise(m_data, m_size, offset, length, MADV_DONTNEED, false);
+	}
+#endif
+
+	MappedFile::~MappedFile()
+	{
+		Unmap();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+		: m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+#if defined(_WIN32)
+		, m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+	{
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Unmap();
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+#if defined(_WIN32)
+			m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+		}
+		return *this;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef __MODERN_CPP_MAPPED_FILE_H
+#define __MODERN_CPP_MAPPED_FILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// A read-only file mapped into memory: the pages come straight from the page cache, nothing is copied
+// into a buffer, and the kernel reads ahead while the scan runs. madvise tells it how the pages are
+// used; on Windows the hints are no-ops.
+//
+//   MappedFile log("big.log");
+//   std::string_view text = log.view();		// valid while log lives
+
+namespace MODERNCPP
+{
+	class MappedFile {
+	public:
+
+		enum class Access { Normal, Sequential, Random };
+
+		// throws std::filesystem::filesystem_error; an empty file maps to an empty view
+		explicit MappedFile(const std::filesystem::path& path, Access access = Access::Sequential);
+		~MappedFile();
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char* data() const noexcept { return m_data; }
+		std::size_t size() const noexcept { return m_size; }
+		std::string_view view() const noexcept { return { m_data, m_size }; }
+
+		// start reading [offset, offset + length) in the background
+		void prefetch(std::size_t offset, std::size_t length) const noexcept;
+
+		// done with [offset, offset + length) for now: the pages wholly inside it leave this process'
+		// resident set, views into them stay valid and touching them reads them back from the page cache
+		void release(std::size_t offset, std::size_t length) const noexcept;
+
+	private:
+
+		void Unmap() noexcept;
+
+		const char* m_data = nullptr;
+		std::size_t m_size = 0;
+#if defined(_WIN32)
+		void* m_mapping = nullptr;
+#endif
+	};
+}
+
+#endif
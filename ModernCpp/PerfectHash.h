@@ -0,0 +1,194 @@
+#pragma once
+
+#ifndef __MODERN_CPP_PERFECT_HASH_H
+#define __MODERN_CPP_PERFECT_HASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+// Perfect hashing built by the compiler: hash, displace and compress (CHD)
+// http://cmph.sourceforge.net/papers/esa09.pdf	(Belazzougui, Botelho & Dietzfelbinger)
+//
+//   static constexpr auto colors = MakePerfectHashMap<std::string_view, std::string_view>({
+//       { "RED", "#FF0000" }, { "GREEN", "#00FF00" } });
+//   colors.find("RED")->second;		// one hash, one slot, one key compare
+
+namespace MODERNCPP
+{
+	// constexpr hashes for the key types fixed tables use: strings, integers and enums
+	template <typename K, typename = void>
+	struct PerfectHashOf;
+
+	template <>
+	struct PerfectHashOf<std::string_view> {
+		static constexpr std::uint64_t Hash(std::string_view s, std::uint64_t seed)
+		{
+			std::uint64_t h = 0xCBF29CE484222325ull ^ seed;			// FNV-1a
+			for (char c : s)
+				h = (h ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+			return h;
+		}
+	};
+
+	template <typename K>
+	struct PerfectHashOf<K, std::enable_if_t<std::is_integral<K>::value || std::is_enum<K>::value>> {
+		static constexpr std::uint64_t Hash(K key, std::uint64_t seed) { return static_cast<std::uint64_t>(key) ^ seed; }
+	};
+
+	// Read-only map fixed at compile time: the entries, a slot table and one displacement per bucket
+	// are constant initialized read-only data, there is no startup work and no allocation.
+	// Building it is the CHD search: buckets of keys, largest first, each gets the first displacement
+	// that sends all its keys to free slots. A lookup hashes the key once, mixes in its bucket's
+	// displacement and compares the one key that slot can hold.
+	template <typename K, typename V, std::size_t N>
+	class PerfectHashMap {
+		static_assert(N > 0, "PerfectHashMap needs at least one entry");
+
+	public:
+
+		using key_type = K;
+		using mapped_type = V;
+		using value_type = std::pair<K, V>;
+		using const_iterator = const value_type*;
+
+		// load at most one half, the displacement search then rarely needs more than a few tries
+		static constexpr std::size_t table_size = [] {
+			std::size_t n = 1;
+			while (n < 2 * N)
+				n *= 2;
+			return n;
+		}();
+		static constexpr std::size_t bucket_count = N;
+
+		constexpr explicit PerfectHashMap(const value_type(&entries)[N]) : PerfectHashMap(entries, std::make_index_sequence<N>()) {}
+
+		// nullptr when the key is not in the table
+		constexpr const value_type* find(const K& key) const
+		{
+			const std::uint64_t h = Mix(Hasher::Hash(key, seed));
+			const std::uint32_t i = m_slots[Slot(h, m_displacements[Bucket(h)])];
+			return i != empty && m_entries[i].first == key ? &m_entries[i] : nullptr;
+		}
+
+		constexpr bool contains(const K& key) const { return find(key) != nullptr; }
+
+		constexpr const V& at(const K& key) const
+		{
+			const value_type* e = find(key);
+			if (!e)
+				throw std::out_of_range("PerfectHashMap::at");
+			return e->second;
+		}
+
+		// in the order they were given
+		constexpr const_iterator begin() const { return m_entries.data(); }
+		constexpr const_iterator end() const { return m_entries.data() + N; }
+		static constexpr std::size_t size() { return N; }
+
+	private:
+
+		using Hasher = PerfectHashOf<K>;
+
+		static constexpr std::uint64_t seed = 0x9E3779B97F4A7C15ull;
+		static constexpr std::uint32_t empty = 0xFFFFFFFF;
+
+		static constexpr std::uint64_t Mix(std::uint64_t x)
+		{
+			x = (x ^ (x >> 33)) * 0xFF51AFD7ED558CCDull;
+			x = (x ^ (x >> 33)) * 0xC4CEB9FE1A85EC53ull;
+			return x ^ (x >> 33);
+		}
+		static constexpr int Log2(std::size_t n) { return n > 1 ? 1 + Log2(n / 2) : 0; }
+
+		// h is mixed once, the displacement costs a multiply: the top bits of a Fibonacci hash
+		static constexpr std::size_t Bucket(std::uint64_t h) { return static_cast<std::size_t>(h % bucket_count); }
+		static constexpr std::size_t Slot(std::uint64_t h, std::uint32_t d)
+		{
+			return table_size == 1 ? 0 : static_cast<std::size_t>(((h ^ d) * 0x9E3779B97F4A7C15ull) >> (64 - Log2(table_size)));
+		}
+
+		template <std::size_t... I>
+		constexpr PerfectHashMap(const value_type(&entries)[N], std::index_sequence<I...>) : m_entries{ { entries[I]... } }
+		{
+			std::uint64_t hashes[N] = {};
+			std::size_t buckets[N] = {};
+			std::size_t first[bucket_count + 1] = {};
+			for (std::size_t i = 0; i < N; ++i)
+			{
+				hashes[i] = Mix(Hasher::Hash(m_entries[i].first, seed));
+				buckets[i] = Bucket(hashes[i]);
+				++first[buckets[i] + 1];
+			}
+
+			// entries grouped by bucket (counting sort), bucket b holds members[first[b] .. first[b + 1])
+			for (std::size_t b = 0; b < bucket_count; ++b)
+				first[b + 1] += first[b];
+			std::size_t members[N] = {};
+			std::size_t fill[bucket_count] = {};
+			for (std::size_t i = 0; i < N; ++i)
+				members[first[buckets[i]] + fill[buckets[i]]++] = i;
+
+			for (std::uint32_t& s : m_slots)
+				s = empty;
+
+			// largest bucket first, they are the hardest to place
+			std::size_t largest = 0;
+			for (std::size_t b = 0; b < bucket_count; ++b)
+				largest = fill[b] > largest ? fill[b] : largest;
+			for (std::size_t size = largest; size > 0; --size)
+			{
+				for (std::size_t b = 0; b < bucket_count; ++b)
+				{
+					if (fill[b] != size)
+						continue;
+					const std::size_t* keys = members + first[b];
+
+					// equal keys share a bucket and no displacement would ever part them
+					for (std::size_t m = 1; m < size; ++m)
+						for (std::size_t o = 0; o < m; ++o)
+							if (hashes[keys[o]] == hashes[keys[m]] && m_entries[keys[o]].first == m_entries[keys[m]].first)
+								throw std::logic_error("PerfectHashMap: duplicate key");
+
+					for (std::uint32_t d = 0; ; ++d)
+					{
+						if (d == empty)
+							throw std::logic_error("PerfectHashMap: no displacement found");
+
+						bool fits = true;
+						for (std::size_t m = 0; m < size && fits; ++m)
+						{
+							const std::size_t s = Slot(hashes[keys[m]], d);
+							fits = m_slots[s] == empty;
+							for (std::size_t o = 0; o < m && fits; ++o)
+								fits = Slot(hashes[keys[o]], d) != s;
+						}
+						if (!fits)
+							continue;
+
+						m_displacements[b] = d;
+						for (std::size_t m = 0; m < size; ++m)
+							m_slots[Slot(hashes[keys[m]], d)] = static_cast<std::uint32_t>(keys[m]);
+						break;
+					}
+				}
+			}
+		}
+
+		std::array<value_type, N> m_entries;
+		std::array<std::uint32_t, table_size> m_slots{};
+		std::array<std::uint32_t, bucket_count> m_displacements{};
+	};
+
+	template <typename K, typename V, std::size_t N>
+	constexpr PerfectHashMap<K, V, N> MakePerfectHashMap(const std::pair<K, V>(&entries)[N])
+	{
+		return PerfectHashMap<K, V, N>(entries);
+	}
+}
+
+#endif
@@ -0,0 +1,419 @@
+#include "pch.h"
+#include "Random.h"
+
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+
+#ifdef MODERNCPP_X86
+#include <immintrin.h>
+#endif
+
+namespace MODERNCPP
+{
+	namespace
+	{
+		const std::size_t block = 256;			// draws per kernel call
+
+		inline std::uint64_t Rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+		inline std::uint64_t MulHi64(std::uint64_t a, std::uint64_t b, std::uint64_t& lo)
+		{
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 m = static_cast<unsigned __int128>(a) * b;
+			lo = static_cast<std::uint64_t>(m);
+			return static_cast<std::uint64_t>(m >> 64);
+#else
+			const std::uint64_t al = a & 0xFFFFFFFF, ah = a >> 32, bl = b & 0xFFFFFFFF, bh = b >> 32;
+			const std::uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+			const std::uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+			lo = (mid << 32) | (ll & 0xFFFFFFFF);
+			return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+		}
+
+		// 52 random bits under the exponent of 1.0 give [1, 2), minus one
+		const std::uint64_t one_bits = 0x3FF0000000000000ull;
+
+		// min + u * scale, every kernel rounds the same two steps so all of them give the same doubles
+		void UnitScalar(const std::uint64_t* in, double* out, std::size_t n, double min, double scale)
+		{
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				const std::uint64_t bits = (in[i] >> 12) | one_bits;
+				double d;
+				std::memcpy(&d, &bits, sizeof(d));
+				out[i] = min + (d - 1.0) * scale;
+			}
+		}
+
+		// out[2i] and out[2i + 1] come from the low and high half of in[i], true if any falls below threshold
+		bool BoundedScalar(const std::uint64_t* in, std::uint32_t* out, std::size_t n, std::uint32_t s, std::uint32_t threshold, std::uint32_t base)
+		{
+			bool redo = false;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				const std::uint32_t x = static_cast<std::uint32_t>(in[i / 2] >> (32 * (i & 1)));
+				const std::uint64_t m = std::uint64_t(x) * s;
+				out[i] = base + static_cast<std::uint32_t>(m >> 32);
+				redo |= static_cast<std::uint32_t>(m) < threshold;
+			}
+			return redo;
+		}
+
+		void GenerateScalar(std::uint64_t (&s)[4][4], std::uint64_t* out, std::size_t n)
+		{
+			for (std::size_t i = 0; i < n; i += 4)
+			{
+				for (std::size_t l = 0; l < 4; ++l)
+				{
+					out[i + l] = Rotl(s[1][l] * 5, 7) * 9;
+					const std::uint64_t t = s[1][l] << 17;
+					s[2][l] ^= s[0][l];
+					s[3][l] ^= s[1][l];
+					s[1][l] ^= s[2][l];
+					s[0][l] ^= s[3][l];
+					s[2][l] ^= t;
+					s[3][l] = Rotl(s[3][l], 45);
+				}
+			}
+		}
+
+#ifdef MODERNCPP_X86
+		// x * 5 and x * 9 are a shift and an add, SSE2 / AVX2 have no 64-bit multiply
+		MODERNCPP_TARGET("sse2")
+		void GenerateSSE2(std::uint64_t (&s)[4][4], std::uint64_t* out, std::size_t n)
+		{
+			auto rotl = [](__m128i x, int k) { return _mm_or_si128(_mm_slli_epi64(x, k), _mm_srli_epi64(x, 64 - k)); };
+
+			for (std::size_t half = 0; half < 4; half += 2)
+			{
+				__m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(&s[0][half]));
+				__m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(&s[1][half]));
+				__m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(&s[2][half]));
+				__m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(&s[3][half]));
+
+				for (std::size_t i = 0; i < n; i += 4)
+				{
+					__m128i x = _mm_add_epi64(s1, _mm_slli_epi64(s1, 2));
+					x = rotl(x, 7);
+					x = _mm_add_epi64(x, _mm_slli_epi64(x, 3));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + half), x);
+
+					const __m128i t = _mm_slli_epi64(s1, 17);
+					s2 = _mm_xor_si128(s2, s0);
+					s3 = _mm_xor_si128(s3, s1);
+					s1 = _mm_xor_si128(s1, s2);
+					s0 = _mm_xor_si128(s0, s3);
+					s2 = _mm_xor_si128(s2, t);
+					s3 = rotl(s3, 45);
+				}
+
+				_mm_store_si128(reinterpret_cast<__m128i*>(&s[0][half]), s0);
+				_mm_store_si128(reinterpret_cast<__m128i*>(&s[1][half]), s1);
+				_mm_store_si128(reinterpret_cast<__m128i*>(&s[2][half]), s2);
+				_mm_store_si128(reinterpret_cast<__m128i*>(&s[3][half]), s3);
+			}
+		}
+
+		// the four lanes' state in registers for the length of one kernel call
+		struct StateAVX2 {
+			__m256i s0, s1, s2, s3;
+
+			MODERNCPP_TARGET("avx2")
+			explicit StateAVX2(const std::uint64_t (&s)[4][4])
+				: s0(_mm256_load_si256(reinterpret_cast<const __m256i*>(s[0]))),
+				s1(_mm256_load_si256(reinterpret_cast<const __m256i*>(s[1]))),
+				s2(_mm256_load_si256(reinterpret_cast<const __m256i*>(s[2]))),
+				s3(_mm256_load_si256(reinterpret_cast<const __m256i*>(s[3]))) {}
+
+			MODERNCPP_TARGET("avx2")
+			void Store(std::uint64_t (&s)[4][4]) const
+			{
+				_mm256_store_si256(reinterpret_cast<__m256i*>(s[0]), s0);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(s[1]), s1);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(s[2]), s2);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(s[3]), s3);
+			}
+
+			MODERNCPP_TARGET("avx2")
+			__m256i Next()
+			{
+				__m256i x = _mm256_add_epi64(s1, _mm256_slli_epi64(s1, 2));
+				x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+				x = _mm256_add_epi64(x, _mm256_slli_epi64(x, 3));
+
+				const __m256i t = _mm256_slli_epi64(s1, 17);
+				s2 = _mm256_xor_si256(s2, s0);
+				s3 = _mm256_xor_si256(s3, s1);
+				s1 = _mm256_xor_si256(s1, s2);
+				s0 = _mm256_xor_si256(s0, s3);
+				s2 = _mm256_xor_si256(s2, t);
+				s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+				return x;
+			}
+		};
+
+		MODERNCPP_TARGET("avx2")
+		void GenerateAVX2(std::uint64_t (&s)[4][4], std::uint64_t* out, std::size_t n)
+		{
+			StateAVX2 state(s);
+			for (std::size_t i = 0; i < n; i += 4)
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), state.Next());
+			state.Store(s);
+		}
+
+		MODERNCPP_TARGET("sse2")
+		void UnitSSE2(const std::uint64_t* in, double* out, std::size_t n, double min, double scale)
+		{
+			const __m128i one = _mm_set1_epi64x(static_cast<long long>(one_bits));
+			const __m128d lo = _mm_set1_pd(min), width = _mm_set1_pd(scale);
+			for (std::size_t i = 0; i < n; i += 2)
+			{
+				const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+				const __m128d d = _mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(x, 12), one));
+				_mm_storeu_pd(out + i, _mm_add_pd(lo, _mm_mul_pd(_mm_sub_pd(d, _mm_set1_pd(1.0)), width)));
+			}
+		}
+
+		// _mm_mul_epu32 multiplies the low halves of the 64-bit lanes, shifting brings up the high halves
+		MODERNCPP_TARGET("sse2")
+		bool BoundedSSE2(const std::uint64_t* in, std::uint32_t* out, std::size_t n, std::uint32_t s, std::uint32_t threshold, std::uint32_t base)
+		{
+			const __m128i offset = _mm_set1_epi32(static_cast<int>(base));
+			const __m128i bound = _mm_set1_epi64x(s);
+			const __m128i low = _mm_set1_epi64x(0xFFFFFFFF);
+			const __m128i sign = _mm_set1_epi32(INT_MIN);
+			const __m128i limit = _mm_set1_epi32(static_cast<int>(threshold ^ 0x80000000u));
+			__m128i rejected = _mm_setzero_si128();
+
+			for (std::size_t i = 0; i < n; i += 4)
+			{
+				const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i / 2));
+				const __m128i plo = _mm_mul_epu32(x, bound);
+				const __m128i phi = _mm_mul_epu32(_mm_srli_epi64(x, 32), bound);
+				const __m128i r = _mm_or_si128(_mm_srli_epi64(plo, 32), _mm_andnot_si128(low, phi));
+				const __m128i l = _mm_or_si128(_mm_and_si128(plo, low), _mm_slli_epi64(phi, 32));
+				// unsigned l < threshold as a signed compare with both sign bits flipped
+				rejected = _mm_or_si128(rejected, _mm_cmplt_epi32(_mm_xor_si128(l, sign), limit));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(r, offset));
+			}
+			return _mm_movemask_epi8(rejected) != 0;
+		}
+
+		// the AVX2 kernels draw in registers, no pass over a buffer of raw draws
+		MODERNCPP_TARGET("avx2")
+		void UnitAVX2(std::uint64_t (&s)[4][4], double* out, std::size_t n, double min, double scale)
+		{
+			const __m256i one = _mm256_set1_epi64x(static_cast<long long>(one_bits));
+			const __m256d lo = _mm256_set1_pd(min), width = _mm256_set1_pd(scale);
+			StateAVX2 state(s);
+			for (std::size_t i = 0; i < n; i += 4)
+			{
+				const __m256d d = _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(state.Next(), 12), one));
+				_mm256_storeu_pd(out + i, _mm256_add_pd(lo, _mm256_mul_pd(_mm256_sub_pd(d, _mm256_set1_pd(1.0)), width)));
+			}
+			state.Store(s);
+		}
+
+		// raw keeps the draws, the rare rejected values are found again in it
+		MODERNCPP_TARGET("avx2")
+		bool BoundedAVX2(std::uint64_t (&st)[4][4], std::uint64_t* raw, std::uint32_t* out, std::size_t n, std::uint32_t s, std::uint32_t threshold, std::uint32_t base)
+		{
+			const __m256i offset = _mm256_set1_epi32(static_cast<int>(base));
+			const __m256i bound = _mm256_set1_epi64x(s);
+			const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+			const __m256i limit = _mm256_set1_epi32(static_cast<int>(threshold));
+			__m256i rejected = _mm256_setzero_si256();
+
+			StateAVX2 state(st);
+			for (std::size_t i = 0; i < n; i += 8)
+			{
+				const __m256i x = state.Next();
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(raw + i / 2), x);
+				const __m256i plo = _mm256_mul_epu32(x, bound);
+				const __m256i phi = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), bound);
+				const __m256i r = _mm256_or_si256(_mm256_srli_epi64(plo, 32), _mm256_andnot_si256(low, phi));
+				const __m256i l = _mm256_or_si256(_mm256_and_si256(plo, low), _mm256_slli_epi64(phi, 32));
+				// l < threshold exactly when max(l, threshold) != l
+				rejected = _mm256_or_si256(rejected, _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(l, limit), l), _mm256_set1_epi32(-1)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(r, offset));
+			}
+			state.Store(st);
+			return !_mm256_testz_si256(rejected, rejected);
+		}
+#endif
+	}
+
+	Xoshiro256x4::Xoshiro256x4(std::uint64_t seed, SimdLevel level)
+		: m_level((std::min)(level, DetectSimd()))
+	{
+		for (auto& word : m_s)
+			for (auto& lane : word)
+				lane = SplitMix64(seed);
+		FixZeroLanes();
+	}
+
+	// an all zero state would only ever produce zeros
+	void Xoshiro256x4::FixZeroLanes()
+	{
+		for (std::size_t l = 0; l < lanes; ++l)
+			if (!(m_s[0][l] | m_s[1][l] | m_s[2][l] | m_s[3][l]))
+				m_s[0][l] = 1;
+	}
+
+	void Xoshiro256x4::generate(std::uint64_t* out, std::size_t n)
+	{
+#ifdef MODERNCPP_X86
+		if (m_level == SimdLevel::AVX2)
+			return GenerateAVX2(m_s, out, n);
+		if (m_level == SimdLevel::SSE2)
+			return GenerateSSE2(m_s, out, n);
+#endif
+		GenerateScalar(m_s, out, n);
+	}
+
+	void Xoshiro256x4::generate_bounded(std::uint32_t* out, std::size_t n, std::uint32_t bound, std::uint32_t base)
+	{
+		std::uint64_t buf[block];
+		std::uint32_t tail[2 * block];
+
+		if (bound == 0)
+		{
+			for (std::size_t i = 0; i < n; i += 2 * block)
+			{
+				generate(buf, block);
+				const std::size_t k = (std::min)(2 * block, n - i);
+				for (std::size_t j = 0; j < k; ++j)
+					out[i + j] = base + static_cast<std::uint32_t>(buf[j / 2] >> (32 * (j & 1)));
+			}
+			return;
+		}
+
+		const std::uint32_t threshold = (0u - bound) % bound;
+
+		// one more draw for every value the bulk pass rejected
+		auto redraw = [this, bound, threshold] {
+			for (;;)
+			{
+				std::uint64_t more[lanes];
+				generate(more, lanes);
+				for (std::uint64_t x : more)
+					for (std::uint32_t w : { static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(x >> 32) })
+					{
+						const std::uint64_t m = std::uint64_t(w) * bound;
+						if (static_cast<std::uint32_t>(m) >= threshold)
+							return static_cast<std::uint32_t>(m >> 32);
+					}
+			}
+		};
+
+		for (std::size_t i = 0; i < n; i += 2 * block)
+		{
+			const std::size_t k = (std::min)(2 * block, n - i);
+			std::uint32_t* dst = k == 2 * block ? out + i : tail;
+
+			bool redo;
+#ifdef MODERNCPP_X86
+			if (m_level == SimdLevel::AVX2)
+				redo = BoundedAVX2(m_s, buf, dst, 2 * block, bound, threshold, base);
+			else
+#endif
+			{
+				generate(buf, block);
+#ifdef MODERNCPP_X86
+				if (m_level == SimdLevel::SSE2)
+					redo = BoundedSSE2(buf, dst, 2 * block, bound, threshold, base);
+				else
+#endif
+					redo = BoundedScalar(buf, dst, 2 * block, bound, threshold, base);
+			}
+
+			if (redo)
+			{
+				for (std::size_t j = 0; j < k; ++j)
+				{
+					const std::uint32_t x = static_cast<std::uint32_t>(buf[j / 2] >> (32 * (j & 1)));
+					if (static_cast<std::uint32_t>(std::uint64_t(x) * bound) < threshold)
+						dst[j] = base + redraw();
+				}
+			}
+			if (dst == tail)
+				std::memcpy(out + i, tail, k * sizeof(std::uint32_t));
+		}
+	}
+
+	void Xoshiro256x4::generate_bounded(std::uint64_t* out, std::size_t n, std::uint64_t bound)
+	{
+		std::uint64_t buf[block];
+		const std::uint64_t threshold = bound ? (0 - bound) % bound : 0;
+		std::size_t next = block;
+
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			for (;;)
+			{
+				if (next == block)
+				{
+					generate(buf, block);
+					next = 0;
+				}
+				const std::uint64_t x = buf[next++];
+				if (bound == 0)
+				{
+					out[i] = x;
+					break;
+				}
+				std::uint64_t lo;
+				const std::uint64_t hi = MulHi64(x, bound, lo);
+				if (lo >= threshold)
+				{
+					out[i] = hi;
+					break;
+				}
+			}
+		}
+	}
+
+	void Xoshiro256x4::generate_unit(double* out, std::size_t n, double min, double scale)
+	{
+		std::uint64_t buf[block];
+		double tail[block];
+
+		for (std::size_t i = 0; i < n; i += block)
+		{
+			const std::size_t k = (std::min)(block, n - i);
+			double* dst = k == block ? out + i : tail;
+#ifdef MODERNCPP_X86
+			if (m_level == SimdLevel::AVX2)
+				UnitAVX2(m_s, dst, block, min, scale);
+			else
+#endif
+			{
+				generate(buf, block);
+#ifdef MODERNCPP_X86
+				if (m_level == SimdLevel::SSE2)
+					UnitSSE2(buf, dst, block, min, scale);
+				else
+#endif
+					UnitScalar(buf, dst, block, min, scale);
+			}
+			if (dst == tail)
+				std::memcpy(out + i, tail, k * sizeof(double));
+		}
+	}
+
+	std::uint64_t ThreadSeed()
+	{
+		// the only std::random_device the process ever opens
+		static const std::uint64_t process = [] {
+			std::random_device rd;
+			return std::uint64_t(rd()) << 32 | rd();
+		}();
+		static std::atomic<std::uint64_t> threads{ 0 };
+
+		std::uint64_t state = process + threads.fetch_add(1, std::memory_order_relaxed) * 0x9E3779B97F4A7C15ull;
+		return SplitMix64(state);
+	}
+}
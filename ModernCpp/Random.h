@@ -0,0 +1,194 @@
+#pragma once
+
+#ifndef __MODERN_CPP_RANDOM_H
+#define __MODERN_CPP_RANDOM_H
+
+#include "Simd.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+// xoshiro256** and unbiased bounded integers
+// https://prng.di.unimi.it/							(Blackman & Vigna, xoshiro / xoroshiro generators)
+// https://arxiv.org/abs/1805.10941					(Lemire, fast random integer generation in an interval)
+
+namespace MODERNCPP
+{
+	inline std::uint64_t SplitMix64(std::uint64_t& state)
+	{
+		std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// xoshiro256**, a drop-in UniformRandomBitGenerator with 32 bytes of state instead of mt19937's 5 KB
+	class Xoshiro256ss {
+	public:
+
+		using result_type = std::uint64_t;
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return (std::numeric_limits<result_type>::max)(); }
+
+		explicit Xoshiro256ss(std::uint64_t seed = 0) { for (auto& w : m_s) w = SplitMix64(seed); }
+
+		template <typename SeedSeq, typename = std::enable_if_t<!std::is_integral<SeedSeq>::value>>
+		explicit Xoshiro256ss(SeedSeq& seq)
+		{
+			std::uint32_t words[8];
+			seq.generate(words, words + 8);
+			for (int i = 0; i < 4; ++i)
+				m_s[i] = std::uint64_t(words[2 * i]) << 32 | words[2 * i + 1];
+			if (!(m_s[0] | m_s[1] | m_s[2] | m_s[3]))
+				m_s[0] = 1;
+		}
+
+		result_type operator()()
+		{
+			const std::uint64_t result = Rotl(m_s[1] * 5, 7) * 9;
+			const std::uint64_t t = m_s[1] << 17;
+			m_s[2] ^= m_s[0];
+			m_s[3] ^= m_s[1];
+			m_s[1] ^= m_s[2];
+			m_s[0] ^= m_s[3];
+			m_s[2] ^= t;
+			m_s[3] = Rotl(m_s[3], 45);
+			return result;
+		}
+
+	private:
+
+		static std::uint64_t Rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+		std::uint64_t m_s[4];
+	};
+
+	// Four independent xoshiro256** streams side by side, one per 64-bit lane of an AVX2 register.
+	// generate() picks the AVX2, SSE2 or scalar kernel at runtime, all three produce the same numbers.
+	class Xoshiro256x4 {
+	public:
+
+		static constexpr std::size_t lanes = 4;
+
+		explicit Xoshiro256x4(std::uint64_t seed = 0, SimdLevel level = DetectSimd());
+
+		template <typename SeedSeq, typename = std::enable_if_t<!std::is_integral<SeedSeq>::value>>
+		explicit Xoshiro256x4(SeedSeq& seq) : m_level(DetectSimd())
+		{
+			std::uint32_t words[2 * 4 * lanes];
+			seq.generate(words, words + 2 * 4 * lanes);
+			for (std::size_t i = 0; i < 4 * lanes; ++i)
+				m_s[i / lanes][i % lanes] = std::uint64_t(words[2 * i]) << 32 | words[2 * i + 1];
+			FixZeroLanes();
+		}
+
+		// raw 64-bit output, n must be a multiple of lanes
+		void generate(std::uint64_t* out, std::size_t n);
+
+		// unbiased in [0, bound), bound 0 is the full range. Lemire's multiply-shift on both
+		// 32-bit halves of every draw, the few draws it rejects are redrawn afterwards.
+		// base is added (mod 2^32) in the same pass, FillUniform needs no second one.
+		void generate_bounded(std::uint32_t* out, std::size_t n, std::uint32_t bound, std::uint32_t base = 0);
+		void generate_bounded(std::uint64_t* out, std::size_t n, std::uint64_t bound);
+
+		// uniform in [0, 1), 52 random mantissa bits
+		void generate_unit(double* out, std::size_t n) { generate_unit(out, n, 0.0, 1.0); }
+		// min + u * scale for the same u, in the same pass
+		void generate_unit(double* out, std::size_t n, double min, double scale);
+
+	private:
+
+		void FixZeroLanes();
+
+		alignas(32) std::uint64_t m_s[4][lanes];		// m_s[word][lane]
+		SimdLevel m_level;
+	};
+
+	// One engine per thread and type, seeded once from the process seed and the thread's index,
+	// so no call ever pays for std::random_device or for seeding mt19937's state again.
+	std::uint64_t ThreadSeed();
+
+	template <typename Engine>
+	Engine& ThreadLocalEngine()
+	{
+		thread_local Engine engine = [] {
+			const std::uint64_t seed = ThreadSeed();
+			std::seed_seq seq{ std::uint32_t(seed), std::uint32_t(seed >> 32) };
+			return Engine(seq);
+		}();
+		return engine;
+	}
+
+	// Fills [first, first + n) with values uniform in [min, max], integers or floating point,
+	// from the calling thread's Xoshiro256x4.
+	template <typename T>
+	void FillUniform(T* first, std::size_t n, T min, T max)
+	{
+		static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "FillUniform fills numbers");
+		Xoshiro256x4& engine = ThreadLocalEngine<Xoshiro256x4>();
+
+		// a chunk at a time, so the second pass over it still hits L1
+		const std::size_t chunk = 512;
+
+		if constexpr (std::is_same<T, double>::value)
+			engine.generate_unit(first, n, min, max - min);
+		else if constexpr (std::is_floating_point<T>::value)
+		{
+			double unit[chunk];
+			const double scale = static_cast<double>(max) - static_cast<double>(min);
+			for (std::size_t i = 0; i < n; i += chunk)
+			{
+				const std::size_t k = (std::min)(chunk, n - i);
+				engine.generate_unit(unit, k);
+				for (std::size_t j = 0; j < k; ++j)
+					first[i + j] = static_cast<T>(min + unit[j] * scale);
+			}
+		}
+		else
+		{
+			using U = std::make_unsigned_t<T>;
+			const U base = static_cast<U>(min);
+			const std::uint64_t range = static_cast<U>(static_cast<U>(max) - base);
+
+			if (range > 0xFFFFFFFF)
+			{
+				std::uint64_t offsets[chunk];
+				for (std::size_t i = 0; i < n; i += chunk)
+				{
+					const std::size_t k = (std::min)(chunk, n - i);
+					engine.generate_bounded(offsets, k, range + 1);
+					for (std::size_t j = 0; j < k; ++j)
+						first[i + j] = static_cast<T>(base + static_cast<U>(offsets[j]));
+				}
+			}
+			else if constexpr (sizeof(T) == sizeof(std::uint32_t))
+			{
+				// int and unsigned may alias each other, the values land in the output directly
+				engine.generate_bounded(reinterpret_cast<std::uint32_t*>(first), n,
+					static_cast<std::uint32_t>(range + 1), static_cast<std::uint32_t>(base));
+			}
+			else
+			{
+				std::uint32_t offsets[chunk];
+				for (std::size_t i = 0; i < n; i += chunk)
+				{
+					const std::size_t k = (std::min)(chunk, n - i);
+					engine.generate_bounded(offsets, k, static_cast<std::uint32_t>(range + 1));
+					for (std::size_t j = 0; j < k; ++j)
+						first[i + j] = static_cast<T>(base + static_cast<U>(offsets[j]));
+				}
+			}
+		}
+	}
+
+	template <typename T>
+	void FillUniform(std::vector<T>& v, T min, T max) { FillUniform(v.data(), v.size(), min, max); }
+}
+
+#endif
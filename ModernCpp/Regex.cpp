@@ -0,0 +1,889 @@
+#include "pch.h"
+#include "Regex.h"
+
+#include <cctype>
+#include <istream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace MODERNCPP
+{
+	struct DfaRegex::NfaState {
+		enum Kind { Set, Split, Accept } kind;
+		std::bitset<256> set{};				// Set: bytes that move on to out
+		int out = -1;
+		int out1 = -1;						// Split: second epsilon edge
+	};
+
+	struct DfaRegex::DfaState {
+		std::vector<int> nfa;				// Set and Accept states, sorted
+		bool accept = false;
+		std::atomic<int> next[256];
+
+		DfaState()
+		{
+			for (auto& n : next)
+				n.store(unknown, std::memory_order_relaxed);
+		}
+	};
+
+	struct DfaRegex::Node {
+		enum Kind { Set, Concat, Alt, Repeat } kind;
+		std::bitset<256> set;
+		std::vector<std::unique_ptr<Node>> kids;
+		int min = 1;
+		int max = 1;						// -1 = unbounded
+
+		explicit Node(Kind k) : kind(k) {}
+	};
+
+	// recursive descent over the ECMAScript grammar, everything outside the subset throws
+	struct DfaRegex::Parser {
+		std::string_view p;
+		std::size_t i = 0;
+		bool icase = false;
+
+		struct Escape {
+			std::bitset<256> set;
+			int ch = -1;					// the single character, -1 for \d \w \s ...
+		};
+
+		static std::unique_ptr<Node> MakeSet(const std::bitset<256>& set)
+		{
+			auto node = std::make_unique<Node>(Node::Set);
+			node->set = set;
+			return node;
+		}
+
+		static void Fold(std::bitset<256>& set)
+		{
+			for (int c = 'a'; c <= 'z'; ++c)
+				if (set[c] || set[c - 'a' + 'A'])
+					set[c] = set[c - 'a' + 'A'] = true;
+		}
+
+		bool More() const { return i < p.size(); }
+		char Peek() const { return p[i]; }
+
+		std::unique_ptr<Node> ParseAlt()
+		{
+			auto first = ParseConcat();
+			if (!More() || Peek() != '|')
+				return first;
+
+			auto alt = std::make_unique<Node>(Node::Alt);
+			alt->kids.push_back(std::move(first));
+			while (More() && Peek() == '|')
+			{
+				++i;
+				alt->kids.push_back(ParseConcat());
+			}
+			return alt;
+		}
+
+		std::unique_ptr<Node> ParseConcat()
+		{
+			auto concat = std::make_unique<Node>(Node::Concat);
+			while (More() && Peek() != '|' && Peek() != ')')
+				concat->kids.push_back(ParseRepeat());
+			return concat;
+		}
+
+		std::unique_ptr<Node> ParseRepeat()
+		{
+			auto atom = ParseAtom();
+			if (!More())
+				return atom;
+
+			int min, max;
+			switch (Peek())
+			{
+			case '*': min = 0; max = -1; ++i; break;
+			case '+': min = 1; max = -1; ++i; break;
+			case '?': min = 0; max = 1; ++i; break;
+			case '{': ParseBraces(min, max); break;
+			default: return atom;
+			}
+
+			if (More() && Peek() == '?')
+				throw std::regex_error(std::regex_constants::error_complexity);		// lazy, not leftmost-longest
+			if (More() && (Peek() == '*' || Peek() == '+' || Peek() == '{'))
+				throw std::regex_error(std::regex_constants::error_badrepeat);
+
+			auto repeat = std::make_unique<Node>(Node::Repeat);
+			repeat->min = min;
+			repeat->max = max;
+			repeat->kids.push_back(std::move(atom));
+			return repeat;
+		}
+
+		int ParseNumber()
+		{
+			if (!More() || Peek() < '0' || Peek() > '9')
+				throw std::regex_error(std::regex_constants::error_badbrace);
+			int n = 0;
+			while (More() && Peek() >= '0' && Peek() <= '9')
+			{
+				n = n * 10 + (Peek() - '0');
+				if (n > 1000)
+					throw std::regex_error(std::regex_constants::error_complexity);
+				++i;
+			}
+			return n;
+		}
+
+		void ParseBraces(int& min, int& max)
+		{
+			++i;
+			min = max = ParseNumber();
+			if (More() && Peek() == ',')
+			{
+				++i;
+				max = (More() && Peek() == '}') ? -1 : ParseNumber();
+			}
+			if (!More() || Peek() != '}')
+				throw std::regex_error(std::regex_constants::error_brace);
+			++i;
+			if (max != -1 && max < min)
+				throw std::regex_error(std::regex_constants::error_badbrace);
+		}
+
+		std::unique_ptr<Node> ParseAtom()
+		{
+			const char c = p[i++];
+			switch (c)
+			{
+			case '(':
+			{
+				if (More() && Peek() == '?')
+				{
+					if (i + 1 < p.size() && p[i + 1] == ':')
+						i += 2;
+					else
+						throw std::regex_error(std::regex_constants::error_complexity);		// lookahead
+				}
+				auto group = ParseAlt();
+				if (!More() || Peek() != ')')
+					throw std::regex_error(std::regex_constants::error_paren);
+				++i;
+				return group;
+			}
+			case '.':
+			{
+				std::bitset<256> set;
+				set.set();
+				set['\n'] = set['\r'] = false;
+				return MakeSet(set);
+			}
+			case '[':
+				return MakeSet(ParseClass());
+			case '\\':
+			{
+				Escape e = ParseEscape(false);
+				if (icase)
+					Fold(e.set);
+				return MakeSet(e.set);
+			}
+			case '^':
+			case '$':
+				throw std::regex_error(std::regex_constants::error_complexity);			// anchors
+			case '*':
+			case '+':
+			case '?':
+			case '{':
+				throw std::regex_error(std::regex_constants::error_badrepeat);
+			default:
+			{
+				std::bitset<256> set;
+				set[static_cast<unsigned char>(c)] = true;
+				if (icase)
+					Fold(set);
+				return MakeSet(set);
+			}
+			}
+		}
+
+		int Hex(std::size_t digits)
+		{
+			int v = 0;
+			for (std::size_t k = 0; k < digits; ++k, ++i)
+			{
+				if (!More())
+					throw std::regex_error(std::regex_constants::error_escape);
+				const char h = Peek();
+				if (h >= '0' && h <= '9') v = v * 16 + (h - '0');
+				else if (h >= 'a' && h <= 'f') v = v * 16 + (h - 'a' + 10);
+				else if (h >= 'A' && h <= 'F') v = v * 16 + (h - 'A' + 10);
+				else throw std::regex_error(std::regex_constants::error_escape);
+			}
+			return v;
+		}
+
+		// after the backslash
+		Escape ParseEscape(bool inClass)
+		{
+			if (!More())
+				throw std::regex_error(std::regex_constants::error_escape);
+
+			Escape e;
+			const char c = p[i++];
+			auto single = [&e](int ch) { e.ch = ch; e.set[static_cast<unsigned char>(ch)] = true; };
+
+			switch (c)
+			{
+			case 'd': case 'D':
+				for (int d = '0'; d <= '9'; ++d) e.set[d] = true;
+				break;
+			case 'w': case 'W':
+				for (int d = '0'; d <= '9'; ++d) e.set[d] = true;
+				for (int a = 'a'; a <= 'z'; ++a) e.set[a] = e.set[a - 'a' + 'A'] = true;
+				e.set['_'] = true;
+				break;
+			case 's': case 'S':
+				for (char s : { ' ', '\t', '\n', '\v', '\f', '\r' }) e.set[static_cast<unsigned char>(s)] = true;
+				break;
+			case 'b':
+				if (!inClass)
+					throw std::regex_error(std::regex_constants::error_complexity);		// word boundary
+				single('\b');
+				break;
+			case 'B':
+				throw std::regex_error(std::regex_constants::error_complexity);
+			case 'n': single('\n'); break;
+			case 't': single('\t'); break;
+			case 'r': single('\r'); break;
+			case 'f': single('\f'); break;
+			case 'v': single('\v'); break;
+			case '0': single('\0'); break;
+			case 'x': single(Hex(2)); break;
+			case 'u':
+			{
+				const int u = Hex(4);
+				if (u > 0xFF)
+					throw std::regex_error(std::regex_constants::error_complexity);
+				single(u);
+				break;
+			}
+			case 'c':
+				if (!More() || !std::isalpha(static_cast<unsigned char>(Peek())))
+					throw std::regex_error(std::regex_constants::error_escape);
+				single(p[i++] % 32);
+				break;
+			default:
+				if (c >= '1' && c <= '9')
+					throw std::regex_error(std::regex_constants::error_backref);
+				single(c);
+				break;
+			}
+
+			if (c == 'D' || c == 'W' || c == 'S')
+				e.set.flip();
+			return e;
+		}
+
+		// after the '['
+		std::bitset<256> ParseClass()
+		{
+			std::bitset<256> set;
+			bool negate = false;
+			if (More() && Peek() == '^')
+			{
+				negate = true;
+				++i;
+			}
+
+			// one class member, ch = -1 when it cannot start a range
+			auto member = [this](int& ch) {
+				const char c = p[i++];
+				if (c == '\\')
+				{
+					Escape e = ParseEscape(true);
+					ch = e.ch;
+					return e.set;
+				}
+				if (c == '[' && More() && (Peek() == ':' || Peek() == '=' || Peek() == '.'))
+					throw std::regex_error(std::regex_constants::error_complexity);		// POSIX classes
+				std::bitset<256> one;
+				one[static_cast<unsigned char>(c)] = true;
+				ch = static_cast<unsigned char>(c);
+				return one;
+			};
+
+			while (More() && Peek() != ']')
+			{
+				int lo;
+				std::bitset<256> m = member(lo);
+				if (lo >= 0 && i + 1 < p.size() && Peek() == '-' && p[i + 1] != ']')
+				{
+					++i;
+					int hi;
+					member(hi);
+					if (hi < 0)
+						throw std::regex_error(std::regex_constants::error_range);
+					if (hi < lo)
+						throw std::regex_error(std::regex_constants::error_range);
+					for (int c = lo; c <= hi; ++c)
+						set[c] = true;
+				}
+				else
+					set |= m;
+			}
+			if (!More())
+				throw std::regex_error(std::regex_constants::error_brack);
+			++i;
+
+			if (icase)
+				Fold(set);
+			if (negate)
+				set.flip();
+			return set;
+		}
+	};
+
+	DfaRegex::DfaRegex(std::string_view pattern, flag_type flags)
+		: m_pattern(pattern), m_flags(flags)
+	{
+		using namespace std::regex_constants;
+		if (flags & (basic | extended | awk | grep | egrep))
+			throw std::regex_error(error_complexity);
+
+		Parser parser{ pattern, 0, (flags & icase) != 0 };
+		const auto root = parser.ParseAlt();
+		if (parser.More())
+			throw std::regex_error(error_paren);			// stray ')'
+
+		m_nfa.push_back({ NfaState::Accept });
+		m_start = Compile(*root, 0);
+
+		std::vector<int> start{ m_start };
+		Closure(start);
+		for (int s : start)
+		{
+			if (m_nfa[s].kind == NfaState::Set)
+				m_first |= m_nfa[s].set;
+			else
+				m_nullable = true;
+		}
+
+		// never reallocates, so searches may index it while another thread appends
+		m_states.reserve(max_states);
+		Intern(std::move(start));
+	}
+
+	DfaRegex::~DfaRegex() = default;
+
+	// Thompson construction back to front: returns the entry state of node, which continues into next
+	int DfaRegex::Compile(const Node& node, int next)
+	{
+		if (m_nfa.size() > 100'000)
+			throw std::regex_error(std::regex_constants::error_complexity);
+
+		auto split = [this](int out, int out1) {
+			NfaState s{ NfaState::Split };
+			s.out = out;
+			s.out1 = out1;
+			m_nfa.push_back(s);
+			return static_cast<int>(m_nfa.size() - 1);
+		};
+
+		switch (node.kind)
+		{
+		case Node::Set:
+		{
+			NfaState s{ NfaState::Set, node.set, next };
+			m_nfa.push_back(s);
+			return static_cast<int>(m_nfa.size() - 1);
+		}
+		case Node::Concat:
+			for (auto it = node.kids.rbegin(); it != node.kids.rend(); ++it)
+				next = Compile(**it, next);
+			return next;
+		case Node::Alt:
+		{
+			int entry = Compile(*node.kids.back(), next);
+			for (auto it = node.kids.rbegin() + 1; it != node.kids.rend(); ++it)
+			{
+				const int branch = Compile(**it, next);
+				entry = split(branch, entry);
+			}
+			return entry;
+		}
+		case Node::Repeat:
+		default:
+		{
+			const Node& kid = *node.kids.front();
+			int tail = next;
+			if (node.max < 0)
+			{
+				const int loop = split(-1, next);
+				m_nfa[loop].out = Compile(kid, loop);
+				tail = loop;
+			}
+			else
+			{
+				for (int k = node.min; k < node.max; ++k)
+				{
+					const int body = Compile(kid, tail);
+					tail = split(body, next);
+				}
+			}
+			for (int k = 0; k < node.min; ++k)
+				tail = Compile(kid, tail);
+			return tail;
+		}
+		}
+	}
+
+	// follow the epsilon edges, keep the states that consume a byte or accept
+	void DfaRegex::Closure(std::vector<int>& set) const
+	{
+		std::vector<char> seen(m_nfa.size(), 0);
+		std::vector<int> stack(set.begin(), set.end());
+		set.clear();
+		while (!stack.empty())
+		{
+			const int s = stack.back();
+			stack.pop_back();
+			if (seen[s])
+				continue;
+			seen[s] = 1;
+			const NfaState& n = m_nfa[s];
+			if (n.kind == NfaState::Split)
+			{
+				stack.push_back(n.out1);
+				stack.push_back(n.out);
+			}
+			else
+				set.push_back(s);
+		}
+		std::sort(set.begin(), set.end());
+	}
+
+	int DfaRegex::Intern(std::vector<int> set) const
+	{
+		if (set.empty())
+			return dead;
+
+		auto it = m_index.find(set);
+		if (it != m_index.end())
+			return it->second;
+		if (m_states.size() == max_states)
+			return full;
+
+		auto state = std::make_unique<DfaState>();
+		state->accept = std::any_of(set.begin(), set.end(), [this](int s) { return m_nfa[s].kind == NfaState::Accept; });
+		state->nfa = set;
+		m_states.push_back(std::move(state));
+
+		const int id = static_cast<int>(m_states.size() - 1);
+		m_index.emplace(std::move(set), id);
+		m_count.store(m_states.size(), std::memory_order_release);
+		return id;
+	}
+
+	int DfaRegex::Next(int state, unsigned char c) const
+	{
+		DfaState& from = *m_states[state];
+		int to = from.next[c].load(std::memory_order_acquire);
+		if (to != unknown)
+			return to;
+
+		std::lock_guard<std::mutex> lock(m_build);
+		to = from.next[c].load(std::memory_order_relaxed);
+		if (to != unknown)
+			return to;
+
+		std::vector<int> set;
+		for (int s : from.nfa)
+			if (m_nfa[s].kind == NfaState::Set && m_nfa[s].set[c])
+				set.push_back(m_nfa[s].out);
+		Closure(set);
+		to = Intern(std::move(set));
+
+		// publishes the new state along with the transition
+		from.next[c].store(to, std::memory_order_release);
+		return to;
+	}
+
+	std::size_t DfaRegex::LongestAt(std::string_view text, std::size_t pos, bool* open, Trail* trail) const
+	{
+		int state = 0;
+		std::size_t longest = m_states[0]->accept ? 0 : std::string_view::npos;
+
+		std::size_t k = pos;
+		const std::size_t plain = trail ? std::min(text.size(), pos + trail_after) : text.size();
+		for (; k < plain; ++k)
+		{
+			const int to = Next(state, static_cast<unsigned char>(text[k]));
+			if (to == dead)
+				return longest;
+			if (to == full)
+				return SlowLongestAt(text, pos, open);
+			state = to;
+			if (m_states[state]->accept)
+				longest = k + 1 - pos;
+		}
+
+		if (k < text.size())
+		{
+			// a long walk: kept in trail, and stopped where a failed one was in the same state
+			trail->walk.clear();
+			trail->walkBegin = k;
+			for (; k < text.size(); ++k)
+			{
+				const int to = Next(state, static_cast<unsigned char>(text[k]));
+				if (to == dead)
+					break;
+				if (to == full)
+					return SlowLongestAt(text, pos, open);
+				state = to;
+				if (m_states[state]->accept)
+					longest = k + 1 - pos;
+				if (k - trail->begin < trail->states.size() && trail->states[k - trail->begin] == state)
+					return longest;
+				trail->walk.push_back(state);
+			}
+			if (k < text.size() || !open)
+			{
+				if (longest == std::string_view::npos && trail->walkBegin + trail->walk.size() > trail->begin + trail->states.size())
+				{
+					trail->states.swap(trail->walk);
+					trail->begin = trail->walkBegin;
+				}
+				return longest;
+			}
+		}
+		if (open)
+			*open = true;
+		return longest;
+	}
+
+	// the same walk over NFA state sets, only used once the DFA has run out of states
+	std::size_t DfaRegex::SlowLongestAt(std::string_view text, std::size_t pos, bool* open) const
+	{
+		auto accepts = [this](const std::vector<int>& set) {
+			return std::any_of(set.begin(), set.end(), [this](int s) { return m_nfa[s].kind == NfaState::Accept; });
+		};
+
+		std::vector<int> set = m_states[0]->nfa, next;
+		std::size_t longest = accepts(set) ? 0 : std::string_view::npos;
+		for (std::size_t k = pos; k < text.size() && !set.empty(); ++k)
+		{
+			const unsigned char c = static_cast<unsigned char>(text[k]);
+			next.clear();
+			for (int s : set)
+				if (m_nfa[s].kind == NfaState::Set && m_nfa[s].set[c])
+					next.push_back(m_nfa[s].out);
+			Closure(next);
+			set.swap(next);
+			if (accepts(set))
+				longest = k + 1 - pos;
+		}
+		if (open && !set.empty())
+			*open = true;
+		return longest;
+	}
+
+	bool DfaRegex::search(std::string_view text, Match& match, std::size_t from) const
+	{
+		Trail trail;
+		for (std::size_t pos = from; pos <= text.size(); ++pos)
+		{
+			if (!m_nullable)
+			{
+				// skip straight to a byte that can start a match
+				while (pos < text.size() && !m_first[static_cast<unsigned char>(text[pos])])
+					++pos;
+				if (pos == text.size())
+					return false;
+			}
+
+			const std::size_t length = LongestAt(text, pos, nullptr, &trail);
+			if (length != std::string_view::npos)
+			{
+				match.position = pos;
+				match.length = length;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool DfaRegex::search_partial(std::string_view text, Match& match, std::size_t from) const
+	{
+		match.length = 0;
+		Trail trail;
+		for (std::size_t pos = from; pos <= text.size(); ++pos)
+		{
+			if (!m_nullable)
+			{
+				while (pos < text.size() && !m_first[static_cast<unsigned char>(text[pos])])
+					++pos;
+				if (pos == text.size())
+					break;
+			}
+
+			bool open = false;
+			const std::size_t length = LongestAt(text, pos, &open, &trail);
+			if (open)
+			{
+				match.position = pos;
+				return false;
+			}
+			if (length != std::string_view::npos)
+			{
+				match.position = pos;
+				match.length = length;
+				return true;
+			}
+		}
+		match.position = text.size();
+		return false;
+	}
+
+	std::string DfaRegex::replace(std::string_view text, std::string_view fmt) const
+	{
+		std::string out;
+		out.reserve(text.size());
+
+		const std::regex* groups = nullptr;
+		std::cmatch match;
+		std::size_t copied = 0;
+		for (DfaRegexIterator it(text, *this), end; it != end; ++it)
+		{
+			const std::size_t pos = it.position();
+			out.append(text, copied, pos - copied);
+			bool grouped = false;
+			for (std::size_t k = 0; k < fmt.size(); ++k)
+			{
+				if (fmt[k] != '$' || k + 1 == fmt.size())
+				{
+					out += fmt[k];
+					continue;
+				}
+				const char c = fmt[++k];
+				if (std::isdigit(static_cast<unsigned char>(c)))
+				{
+					// one or two digits, as std::match_results::format reads them
+					int group = c - '0';
+					if (k + 1 < fmt.size() && std::isdigit(static_cast<unsigned char>(fmt[k + 1])))
+						group = group * 10 + (fmt[++k] - '0');
+					if (group == 0)
+					{
+						out.append(it->data(), it->size());
+						continue;
+					}
+					if (!grouped)
+					{
+						if (!groups)
+							groups = &RegexCache::Instance().Regex(m_pattern, m_flags);
+						if (!std::regex_match(it->data(), it->data() + it->size(), match, *groups))
+							match = std::cmatch();
+						grouped = true;
+					}
+					if (static_cast<std::size_t>(group) < match.size() && match[group].matched)
+						out.append(match[group].first, match[group].length());
+					continue;
+				}
+				switch (c)
+				{
+				case '&': out.append(it->data(), it->size()); break;
+				case '`': out.append(text, copied, pos - copied); break;		// since the previous match, as std::regex_replace
+				case '\'': out.append(text, pos + it->size(), std::string_view::npos); break;
+				case '$': out += '$'; break;
+				default: out += '$'; out += c; break;
+				}
+			}
+			copied = pos + it->size();
+		}
+		out.append(text, copied, std::string_view::npos);
+		return out;
+	}
+
+	RegexReplaceStream::RegexReplaceStream(const std::string& pattern, std::string_view fmt, Sink sink, flag_type flags)
+		: m_re(RegexCache::Instance().Dfa(pattern, flags)), m_sink(std::move(sink))
+	{
+		// fmt split into literals and group references once, not per match
+		auto literal = [this]() -> std::string& {
+			if (m_fmt.empty() || m_fmt.back().group >= 0)
+				m_fmt.emplace_back();
+			return m_fmt.back().literal;
+		};
+		for (std::size_t k = 0; k < fmt.size(); ++k)
+		{
+			if (fmt[k] != '$' || k + 1 == fmt.size())
+			{
+				literal() += fmt[k];
+				continue;
+			}
+			const char c = fmt[++k];
+			if (c == '&')
+				m_fmt.push_back({ {}, 0 });
+			else if (c == '$')
+				literal() += '$';
+			else if (c == '`' || c == '\'')
+				throw std::invalid_argument("RegexReplaceStream: $` and $' need the whole text");
+			else if (std::isdigit(static_cast<unsigned char>(c)))
+			{
+				// one or two digits, as std::match_results::format reads them
+				int group = c - '0';
+				if (k + 1 < fmt.size() && std::isdigit(static_cast<unsigned char>(fmt[k + 1])))
+					group = group * 10 + (fmt[++k] - '0');
+				m_fmt.push_back({ {}, group });
+				if (group > 0 && !m_groups)
+					m_groups = &RegexCache::Instance().Regex(pattern, flags);
+			}
+			else
+			{
+				literal() += '$';
+				literal() += c;
+			}
+		}
+	}
+
+	void RegexReplaceStream::write(std::string_view text)
+	{
+		if (m_held.empty())
+		{
+			// most pieces start outside a match, no copy then
+			const std::size_t held = Replace(text, false);
+			m_held.assign(text, held);
+		}
+		else
+		{
+			m_held.append(text.data(), text.size());
+			m_held.erase(0, Replace(m_held, false));
+		}
+		Flush();
+	}
+
+	void RegexReplaceStream::finish()
+	{
+		Replace(m_held, true);
+		m_held.clear();
+		Flush();
+	}
+
+	std::size_t RegexReplaceStream::Replace(std::string_view text, bool last)
+	{
+		std::size_t copied = 0;
+		DfaRegex::Match m;
+		for (std::size_t from = 0; from <= text.size();)
+		{
+			if (!(last ? m_re.search(text, m, from) : m_re.search_partial(text, m, from)))
+			{
+				if (last)
+					break;
+				Emit(text.substr(copied, m.position - copied));
+				return m.position;
+			}
+			Emit(text.substr(copied, m.position - copied));
+			Format(text.substr(m.position, m.length));
+			copied = m.position + m.length;
+			from = copied + (m.length ? 0 : 1);
+		}
+		Emit(text.substr(copied));
+		return text.size();
+	}
+
+	void RegexReplaceStream::Format(std::string_view match)
+	{
+		bool grouped = false;
+		for (const Part& part : m_fmt)
+		{
+			if (part.group < 0)
+				Emit(part.literal);
+			else if (part.group == 0)
+				Emit(match);
+			else
+			{
+				// the DFA found where the match is, std::regex only splits it into groups
+				if (!grouped)
+				{
+					if (!std::regex_match(match.data(), match.data() + match.size(), m_match, *m_groups))
+						m_match = std::cmatch();
+					grouped = true;
+				}
+				if (static_cast<std::size_t>(part.group) < m_match.size() && m_match[part.group].matched)
+					Emit(std::string_view(m_match[part.group].first, m_match[part.group].length()));
+			}
+		}
+	}
+
+	void RegexReplaceStream::Emit(std::string_view text)
+	{
+		m_out.append(text.data(), text.size());
+		if (m_out.size() >= flush_size)
+			Flush();
+	}
+
+	void RegexReplaceStream::Flush()
+	{
+		if (!m_out.empty())
+			m_sink(m_out);
+		m_out.clear();
+	}
+
+	void RegexReplace(std::istream& in, const std::string& pattern, std::string_view fmt, const RegexReplaceStream::Sink& sink,
+		RegexReplaceStream::flag_type flags, std::size_t chunk)
+	{
+		RegexReplaceStream replace(pattern, fmt, sink, flags);
+		std::unique_ptr<char[]> buffer(new char[chunk]);
+		while (in)
+		{
+			in.read(buffer.get(), static_cast<std::streamsize>(chunk));
+			if (in.gcount() > 0)
+				replace.write(std::string_view(buffer.get(), static_cast<std::size_t>(in.gcount())));
+		}
+		replace.finish();
+	}
+
+	RegexCache& RegexCache::Instance()
+	{
+		static RegexCache cache;
+		return cache;
+	}
+
+	RegexCache::Entry& RegexCache::Find(const std::string& pattern, flag_type flags, bool dfa)
+	{
+		const std::string key = std::to_string(static_cast<unsigned>(flags)) + '/' + pattern;
+		{
+			std::shared_lock<std::shared_mutex> lock(m_mutex);
+			auto it = m_entries.find(key);
+			if (it != m_entries.end() && (dfa ? it->second.dfaTried : it->second.regex != nullptr))
+				return it->second;
+		}
+
+		// compile under the exclusive lock, every pattern is compiled once per process
+		std::unique_lock<std::shared_mutex> lock(m_mutex);
+		Entry& entry = m_entries[key];
+		if (dfa && !entry.dfaTried)
+		{
+			try
+			{
+				entry.dfa = std::make_unique<const DfaRegex>(pattern, flags);
+			}
+			catch (const std::regex_error& e)
+			{
+				entry.dfaError = e.code();
+			}
+			entry.dfaTried = true;
+		}
+		else if (!dfa && !entry.regex)
+			entry.regex = std::make_unique<const std::regex>(pattern, flags);
+		return entry;
+	}
+
+	const std::regex& RegexCache::Regex(const std::string& pattern, flag_type flags)
+	{
+		return *Find(pattern, flags, false).regex;
+	}
+
+	const DfaRegex& RegexCache::Dfa(const std::string& pattern, flag_type flags)
+	{
+		const Entry& entry = Find(pattern, flags, true);
+		if (!entry.dfa)
+			throw std::regex_error(entry.dfaError);
+		return *entry.dfa;
+	}
+}
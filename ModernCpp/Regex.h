@@ -0,0 +1,249 @@
+#pragma once
+
+#ifndef __MODERN_CPP_REGEX_H
+#define __MODERN_CPP_REGEX_H
+
+#include <map>
+#include <mutex>
+#include <regex>
+#include <atomic>
+#include <bitset>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <iterator>
+#include <functional>
+#include <string_view>
+#include <shared_mutex>
+#include <unordered_map>
+
+// Compiled pattern cache and a lazily built DFA for the regular subset of ECMAScript
+// https://swtch.com/~rsc/regexp/regexp1.html	(Thompson NFA, DFA construction on the fly)
+
+namespace MODERNCPP
+{
+	// Matches the backreference free subset of ECMAScript: literals, '.', classes ([...], \d \w \s and
+	// their negations), groups ((...) and (?:...)), '|' and greedy * + ? {n} {n,} {n,m}.
+	// Anchors, assertions, backreferences and lazy quantifiers throw std::regex_error, use std::regex there.
+	// Groups do not capture. Matches are leftmost-longest, which is what ECMAScript finds too
+	// unless an alternation offers a shorter branch first (a|ab).
+	// DFA states are built the first time a search needs them and shared by every thread afterwards.
+	class DfaRegex {
+	public:
+
+		using flag_type = std::regex_constants::syntax_option_type;
+
+		struct Match {
+			std::size_t position = 0;
+			std::size_t length = 0;
+		};
+
+		explicit DfaRegex(std::string_view pattern, flag_type flags = std::regex_constants::ECMAScript);
+		~DfaRegex();
+
+		DfaRegex(const DfaRegex&) = delete;
+		DfaRegex& operator=(const DfaRegex&) = delete;
+
+		bool search(std::string_view text) const { Match m; return search(text, m); }
+
+		// leftmost match starting at or after from
+		bool search(std::string_view text, Match& match, std::size_t from = 0) const;
+
+		// search on text that goes on past its end: a match that could still start or grow in the text
+		// to come is not decided yet, false with match.position where it starts. Without a match
+		// match.position is text.size(), nothing before match.position can be part of a later match.
+		bool search_partial(std::string_view text, Match& match, std::size_t from = 0) const;
+
+		// like std::regex_replace, fmt understands $& $` $' $$ and $0 .. $99. $n takes the groups from
+		// std::regex_match on the match alone, as RegexReplaceStream does, it suits short matches.
+		std::string replace(std::string_view text, std::string_view fmt) const;
+
+		std::size_t state_count() const { return m_count.load(std::memory_order_acquire); }
+
+	private:
+
+		struct NfaState;
+		struct DfaState;
+		struct Node;
+		struct Parser;
+
+		static constexpr int dead = -1;			// no match can continue
+		static constexpr int unknown = -2;		// transition not built yet
+		static constexpr int full = -3;			// out of DFA states, fall back to the NFA
+		static constexpr std::size_t max_states = 4096;
+		static constexpr std::size_t trail_after = 64;	// walks shorter than this are not kept in a Trail
+
+		// A search tries the start positions left to right, so every walk before the one that matches
+		// failed. The DFA is deterministic: a walk in the same state at the same byte as a failed one
+		// fails from there too and stops. Without it every start of a pattern like error.*timeout walks
+		// to the end of the line, quadratic in the line length.
+		struct Trail {
+			std::size_t begin = 0;
+			std::vector<int> states;		// after each byte from begin, of the failed walk that got furthest
+			std::size_t walkBegin = 0;
+			std::vector<int> walk;			// the same for the walk in progress
+		};
+
+		int Compile(const Node& node, int next);
+		void Closure(std::vector<int>& set) const;
+		int Intern(std::vector<int> set) const;			// caller holds m_build
+		int Next(int state, unsigned char c) const;
+		// npos = no match; open = the match could go on past the end of text
+		std::size_t LongestAt(std::string_view text, std::size_t pos, bool* open = nullptr, Trail* trail = nullptr) const;
+		std::size_t SlowLongestAt(std::string_view text, std::size_t pos, bool* open) const;
+
+		std::string m_pattern;				// for the std::regex that finds the groups of $n
+		flag_type m_flags;
+		std::vector<NfaState> m_nfa;
+		int m_start = 0;
+		std::bitset<256> m_first;			// bytes a non-empty match can start with
+		bool m_nullable = false;			// matches the empty string
+
+		// states are only appended, readers reach them through the atomic transitions
+		mutable std::vector<std::unique_ptr<DfaState>> m_states;
+		mutable std::atomic<std::size_t> m_count{ 0 };
+		mutable std::map<std::vector<int>, int> m_index;
+		mutable std::mutex m_build;
+	};
+
+	// Iterates the matches of a DfaRegex the way std::sregex_iterator does, default constructed is the end
+	class DfaRegexIterator {
+	public:
+
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const std::string_view*;
+		using reference = const std::string_view&;
+
+		DfaRegexIterator() = default;
+		DfaRegexIterator(std::string_view text, const DfaRegex& re) : m_text(text), m_re(&re) { Find(0); }
+
+		reference operator*() const { return m_match; }
+		pointer operator->() const { return &m_match; }
+		std::size_t position() const { return m_pos.position; }
+
+		DfaRegexIterator& operator++()
+		{
+			Find(m_pos.position + (m_pos.length ? m_pos.length : 1));
+			return *this;
+		}
+		DfaRegexIterator operator++(int) { DfaRegexIterator tmp = *this; ++*this; return tmp; }
+
+		bool operator==(const DfaRegexIterator& rhs) const
+		{
+			return m_re == rhs.m_re && (m_re == nullptr || m_pos.position == rhs.m_pos.position);
+		}
+		bool operator!=(const DfaRegexIterator& rhs) const { return !(*this == rhs); }
+
+	private:
+
+		void Find(std::size_t from)
+		{
+			if (from > m_text.size() || !m_re->search(m_text, m_pos, from))
+			{
+				m_re = nullptr;
+				return;
+			}
+			m_match = m_text.substr(m_pos.position, m_pos.length);
+		}
+
+		std::string_view m_text;
+		const DfaRegex* m_re = nullptr;
+		DfaRegex::Match m_pos;
+		std::string_view m_match;
+	};
+
+	// std::regex_replace for text that arrives in pieces: the matches are found by a DfaRegex, which
+	// carries a match across the pieces, and the output leaves through sink in pieces of up to 64 KB.
+	// Memory stays at a piece plus the longest match in progress (a pattern like .* that never fails
+	// on the input holds all of it back).
+	//
+	//   RegexReplaceStream replace("(\\w{7,})", "[$1]", [&](std::string_view out) { file << out; });
+	//   while (ReadChunk(in, chunk))
+	//       replace.write(chunk);
+	//   replace.finish();
+	//
+	// fmt understands $& $0 .. $99 and $$ the way std::regex_replace does. $n finds the groups with
+	// std::regex_match on the match alone, the whole text is not needed for them, but libstdc++
+	// recurses per character there, it suits short matches. $` and $' would need the whole text and
+	// throw std::invalid_argument.
+	class RegexReplaceStream {
+	public:
+
+		using flag_type = std::regex_constants::syntax_option_type;
+		using Sink = std::function<void(std::string_view)>;
+
+		static constexpr std::size_t flush_size = 64 * 1024;
+
+		// throws std::regex_error when the pattern is outside DfaRegex's subset
+		RegexReplaceStream(const std::string& pattern, std::string_view fmt, Sink sink,
+			flag_type flags = std::regex_constants::ECMAScript);
+
+		void write(std::string_view text);
+
+		// the end of the text: what was held back is replaced and everything goes to sink,
+		// write starts a new text after it
+		void finish();
+
+		// bytes held back, a match may still start in them
+		std::size_t held() const { return m_held.size(); }
+
+	private:
+
+		struct Part {
+			std::string literal;
+			int group = -1;				// -1 = literal, 0 = the whole match
+		};
+
+		std::size_t Replace(std::string_view text, bool last);		// returns where the text held back starts
+		void Format(std::string_view match);
+		void Emit(std::string_view text);
+		void Flush();
+
+		const DfaRegex& m_re;
+		const std::regex* m_groups = nullptr;		// only when fmt refers to a group
+		std::vector<Part> m_fmt;
+		Sink m_sink;
+		std::string m_held;
+		std::string m_out;
+		std::cmatch m_match;
+	};
+
+	// everything in reaches sink replaced, read chunk bytes at a time
+	void RegexReplace(std::istream& in, const std::string& pattern, std::string_view fmt, const RegexReplaceStream::Sink& sink,
+		RegexReplaceStream::flag_type flags = std::regex_constants::ECMAScript, std::size_t chunk = 64 * 1024);
+
+	// Process wide cache of compiled patterns keyed by pattern text and flags.
+	// Entries live as long as the process, the returned references stay valid.
+	class RegexCache {
+	public:
+
+		using flag_type = std::regex_constants::syntax_option_type;
+
+		static RegexCache& Instance();
+
+		const std::regex& Regex(const std::string& pattern, flag_type flags = std::regex_constants::ECMAScript);
+
+		// throws std::regex_error when the pattern is outside DfaRegex's subset
+		const DfaRegex& Dfa(const std::string& pattern, flag_type flags = std::regex_constants::ECMAScript);
+
+	private:
+
+		struct Entry {
+			std::unique_ptr<const std::regex> regex;
+			std::unique_ptr<const DfaRegex> dfa;
+			std::regex_constants::error_type dfaError{};
+			bool dfaTried = false;
+		};
+
+		Entry& Find(const std::string& pattern, flag_type flags, bool dfa);
+
+		std::shared_mutex m_mutex;
+		std::unordered_map<std::string, Entry> m_entries;		// key: flags, '/', pattern
+	};
+}
+
+#endif
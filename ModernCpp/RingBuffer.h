@@ -0,0 +1,282 @@
+#pragma once
+
+#ifndef __MODERN_CPP_RING_BUFFER_H
+#define __MODERN_CPP_RING_BUFFER_H
+
+#include <new>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+// Bounded lock-free ring buffers
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// https://rigtorp.se/ringbuffer/
+
+namespace MODERNCPP
+{
+	// std::hardware_destructive_interference_size is C++17, but not every compiler ships it (and
+	// GCC warns when it leaks into a header), so fix the padding at the common x86/ARM line size.
+	constexpr std::size_t cache_line_size = 64;
+
+	// round up to the next power of two, so index wrapping is a mask instead of a modulo
+	constexpr std::size_t ceil_pow2(std::size_t n)
+	{
+		std::size_t p = 1;
+		while (p < n)
+			p <<= 1;
+		return p;
+	}
+
+	// Single producer, single consumer.
+	// Exactly one thread may push and exactly one (other) thread may pop.
+	template <typename T>
+	class SpscRingBuffer {
+	public:
+
+		explicit SpscRingBuffer(std::size_t capacity)
+			: m_mask(ceil_pow2(capacity < 2 ? 2 : capacity) - 1),
+			  m_slots(new Slot[m_mask + 1])
+		{}
+
+		SpscRingBuffer(const SpscRingBuffer&) = delete;
+		SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+		~SpscRingBuffer()
+		{
+			const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+			for (std::size_t i = m_head.load(std::memory_order_relaxed); i != tail; ++i)
+				m_slots[i & m_mask].ptr()->~T();
+		}
+
+		template <typename... Args>
+		bool try_emplace(Args&&... args)
+		{
+			const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_cachedHead > m_mask)
+			{
+				// looks full, refresh our view of the consumer
+				m_cachedHead = m_head.load(std::memory_order_acquire);
+				if (tail - m_cachedHead > m_mask)
+					return false;
+			}
+			new (m_slots[tail & m_mask].ptr()) T(std::forward<Args>(args)...);
+			m_tail.store(tail + 1, std::memory_order_release);	// publish the element
+			return true;
+		}
+
+		bool try_push(const T& v) { return try_emplace(v); }
+		bool try_push(T&& v) { return try_emplace(std::move(v)); }
+
+		bool try_pop(T& out)
+		{
+			const std::size_t head = m_head.load(std::memory_order_relaxed);
+			if (head == m_cachedTail)
+			{
+				// looks empty, refresh our view of the producer
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+				if (head == m_cachedTail)
+					return false;
+			}
+			T* p = m_slots[head & m_mask].ptr();
+			out = std::move(*p);
+			p->~T();
+			m_head.store(head + 1, std::memory_order_release);	// hand the slot back
+			return true;
+		}
+
+		// pushes up to n elements with a single release store, returns how many were taken
+		std::size_t push_bulk(const T* first, std::size_t n)
+		{
+			const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+			std::size_t free = m_mask + 1 - (tail - m_cachedHead);
+			if (free < n)
+			{
+				m_cachedHead = m_head.load(std::memory_order_acquire);
+				free = m_mask + 1 - (tail - m_cachedHead);
+			}
+			if (n > free)
+				n = free;
+			for (std::size_t i = 0; i < n; ++i)
+				new (m_slots[(tail + i) & m_mask].ptr()) T(first[i]);
+			m_tail.store(tail + n, std::memory_order_release);
+			return n;
+		}
+
+		// pops up to n elements with a single release store, returns how many were written to out
+		std::size_t pop_bulk(T* out, std::size_t n)
+		{
+			const std::size_t head = m_head.load(std::memory_order_relaxed);
+			std::size_t avail = m_cachedTail - head;
+			if (avail < n)
+			{
+				m_cachedTail = m_tail.load(std::memory_order_acquire);
+				avail = m_cachedTail - head;
+			}
+			if (n > avail)
+				n = avail;
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				T* p = m_slots[(head + i) & m_mask].ptr();
+				out[i] = std::move(*p);
+				p->~T();
+			}
+			m_head.store(head + n, std::memory_order_release);
+			return n;
+		}
+
+		// only a snapshot when both sides are running
+		std::size_t size() const
+		{
+			return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+		}
+
+		bool empty() const { return size() == 0; }
+		std::size_t capacity() const { return m_mask + 1; }
+
+	private:
+
+		struct Slot {
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+			T* ptr() { return reinterpret_cast<T*>(&storage); }
+		};
+
+		const std::size_t m_mask;
+		const std::unique_ptr<Slot[]> m_slots;
+
+		// consumer side: own index plus a private copy of the producer's index
+		alignas(cache_line_size) std::atomic<std::size_t> m_head{ 0 };
+		std::size_t m_cachedTail = 0;
+
+		// producer side: own index plus a private copy of the consumer's index
+		alignas(cache_line_size) std::atomic<std::size_t> m_tail{ 0 };
+		std::size_t m_cachedHead = 0;
+	};
+
+	// Multi producer, multi consumer (Dmitry Vyukov's bounded queue).
+	// Every slot carries a sequence number telling producers and consumers whose turn it is,
+	// so the only contended writes are the CAS on the enqueue/dequeue positions.
+	template <typename T>
+	class MpmcRingBuffer {
+	public:
+
+		explicit MpmcRingBuffer(std::size_t capacity)
+			: m_mask(ceil_pow2(capacity < 2 ? 2 : capacity) - 1),
+			  m_slots(new Slot[m_mask + 1])
+		{
+			for (std::size_t i = 0; i <= m_mask; ++i)
+				m_slots[i].seq.store(i, std::memory_order_relaxed);
+		}
+
+		MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+		MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+		// no other thread may touch the queue by now, so every slot in [head, tail) is filled
+		~MpmcRingBuffer()
+		{
+			const std::size_t tail = m_enqueuePos.load(std::memory_order_relaxed);
+			for (std::size_t i = m_dequeuePos.load(std::memory_order_relaxed); i != tail; ++i)
+				m_slots[i & m_mask].ptr()->~T();
+		}
+
+		template <typename... Args>
+		bool try_emplace(Args&&... args)
+		{
+			Slot* slot;
+			std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				slot = &m_slots[pos & m_mask];
+				const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+				const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+				if (dif == 0)
+				{
+					if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (dif < 0)
+					return false;		// full
+				else
+					pos = m_enqueuePos.load(std::memory_order_relaxed);
+			}
+			new (slot->ptr()) T(std::forward<Args>(args)...);
+			slot->seq.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool try_push(const T& v) { return try_emplace(v); }
+		bool try_push(T&& v) { return try_emplace(std::move(v)); }
+
+		bool try_pop(T& out)
+		{
+			Slot* slot;
+			std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				slot = &m_slots[pos & m_mask];
+				const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+				const std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+				if (dif == 0)
+				{
+					if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (dif < 0)
+					return false;		// empty
+				else
+					pos = m_dequeuePos.load(std::memory_order_relaxed);
+			}
+			T* p = slot->ptr();
+			out = std::move(*p);
+			p->~T();
+			slot->seq.store(pos + m_mask + 1, std::memory_order_release);	// free for the next lap
+			return true;
+		}
+
+		// slots are claimed one by one (another producer may own the slot in between),
+		// but the loop stops at the first full/empty answer instead of retrying
+		std::size_t push_bulk(const T* first, std::size_t n)
+		{
+			std::size_t i = 0;
+			while (i < n && try_push(first[i]))
+				++i;
+			return i;
+		}
+
+		std::size_t pop_bulk(T* out, std::size_t n)
+		{
+			std::size_t i = 0;
+			while (i < n && try_pop(out[i]))
+				++i;
+			return i;
+		}
+
+		// only a snapshot when other threads are running
+		std::size_t size() const
+		{
+			const std::size_t tail = m_enqueuePos.load(std::memory_order_acquire);
+			const std::size_t head = m_dequeuePos.load(std::memory_order_acquire);
+			return tail > head ? tail - head : 0;
+		}
+
+		bool empty() const { return size() == 0; }
+		std::size_t capacity() const { return m_mask + 1; }
+
+	private:
+
+		struct Slot {
+			std::atomic<std::size_t> seq;
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+			T* ptr() { return reinterpret_cast<T*>(&storage); }
+		};
+
+		const std::size_t m_mask;
+		const std::unique_ptr<Slot[]> m_slots;
+
+		alignas(cache_line_size) std::atomic<std::size_t> m_enqueuePos{ 0 };
+		alignas(cache_line_size) std::atomic<std::size_t> m_dequeuePos{ 0 };
+	};
+}
+
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+#ifndef __MODERN_CPP_SEQ_LOCK_H
+#define __MODERN_CPP_SEQ_LOCK_H
+
+#include "RingBuffer.h"
+
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+// Sequence lock for read-mostly state
+// https://www.hpl.hp.com/techreports/2012/HPL-2012-68.pdf	(Boehm, seqlocks and the C++11 memory model)
+
+namespace MODERNCPP
+{
+	// Readers copy the value and retry if a writer was active meanwhile, they never write
+	// shared memory, so any number of them can read without bouncing a cache line.
+	// Writers serialize on the sequence number (odd = write in progress).
+	// The payload lives in relaxed atomic words, which keeps the racing copy well defined.
+	template <typename T>
+	class SeqLocked {
+		static_assert(std::is_trivially_copyable<T>::value, "SeqLocked<T> copies T byte-wise");
+
+	public:
+
+		SeqLocked() : SeqLocked(T{}) {}
+		explicit SeqLocked(const T& value) { Write(value); }
+
+		SeqLocked(const SeqLocked&) = delete;
+		SeqLocked& operator=(const SeqLocked&) = delete;
+
+		// consistent snapshot, spins while a write is in progress
+		T load() const
+		{
+			Words buf;
+			for (;;)
+			{
+				const std::uint64_t s1 = m_seq.load(std::memory_order_acquire);
+				if (s1 & 1)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				for (std::size_t i = 0; i < words; ++i)
+					buf[i] = m_data[i].load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (m_seq.load(std::memory_order_relaxed) == s1)
+					break;
+			}
+			T out;
+			std::memcpy(&out, buf, sizeof(T));
+			return out;
+		}
+
+		void store(const T& value)
+		{
+			const std::uint64_t s = Lock();
+			Write(value);
+			m_seq.store(s + 2, std::memory_order_release);
+		}
+
+		// read-modify-write under the writer lock, f(T&)
+		template <typename F>
+		void update(F&& f)
+		{
+			const std::uint64_t s = Lock();
+			Words buf;
+			for (std::size_t i = 0; i < words; ++i)
+				buf[i] = m_data[i].load(std::memory_order_relaxed);
+			T value;
+			std::memcpy(&value, buf, sizeof(T));
+			f(value);
+			Write(value);
+			m_seq.store(s + 2, std::memory_order_release);
+		}
+
+		// how many writes completed so far
+		std::uint64_t version() const { return m_seq.load(std::memory_order_acquire) / 2; }
+
+	private:
+
+		static constexpr std::size_t words = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+		using Words = std::uint64_t[words];
+
+		// makes the sequence odd, returns the even value it had
+		std::uint64_t Lock()
+		{
+			std::uint64_t s = m_seq.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				if (!(s & 1) && m_seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed))
+					break;
+				std::this_thread::yield();
+				s = m_seq.load(std::memory_order_relaxed);
+			}
+			// nothing below may become visible before the odd sequence number
+			std::atomic_thread_fence(std::memory_order_release);
+			return s;
+		}
+
+		void Write(const T& value)
+		{
+			Words buf = {};
+			std::memcpy(buf, &value, sizeof(T));
+			for (std::size_t i = 0; i < words; ++i)
+				m_data[i].store(buf[i], std::memory_order_relaxed);
+		}
+
+		alignas(cache_line_size) std::atomic<std::uint64_t> m_seq{ 0 };
+		std::atomic<std::uint64_t> m_data[words];
+	};
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "pch.h"
+#include "Simd.h"
+
+#ifdef MODERNCPP_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace MODERNCPP
+{
+#ifdef MODERNCPP_X86
+	namespace
+	{
+		void Cpuid(int leaf, int sub, unsigned regs[4])
+		{
+#if defined(_MSC_VER)
+			int r[4];
+			__cpuidex(r, leaf, sub);
+			for (int i = 0; i < 4; ++i)
+				regs[i] = static_cast<unsigned>(r[i]);
+#else
+			__cpuid_count(leaf, sub, regs[0], regs[1], regs[2], regs[3]);
+#endif
+		}
+
+		// XCR0, which register state the OS saves on a context switch
+		std::uint64_t Xgetbv()
+		{
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#else
+			unsigned lo, hi;
+			__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+			return (std::uint64_t(hi) << 32) | lo;
+#endif
+		}
+
+		SimdLevel Probe()
+		{
+			unsigned regs[4];
+			Cpuid(0, 0, regs);
+			const unsigned maxLeaf = regs[0];
+
+			Cpuid(1, 0, regs);
+			const bool sse2 = (regs[3] >> 26) & 1;
+			const bool osxsave = (regs[2] >> 27) & 1;
+			const bool avx = (regs[2] >> 28) & 1;
+			if (!sse2)
+				return SimdLevel::Scalar;
+
+			// AVX2 also needs the OS to preserve the YMM registers
+			if (maxLeaf >= 7 && osxsave && avx && (Xgetbv() & 0x6) == 0x6)
+			{
+				Cpuid(7, 0, regs);
+				if ((regs[1] >> 5) & 1)
+					return SimdLevel::AVX2;
+			}
+			return SimdLevel::SSE2;
+		}
+	}
+#endif
+
+	SimdLevel DetectSimd()
+	{
+#ifdef MODERNCPP_X86
+		static const SimdLevel level = Probe();
+		return level;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}
+
+	const char* ToString(SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::SSE2: return "SSE2";
+		case SimdLevel::AVX2: return "AVX2";
+		default: return "scalar";
+		}
+	}
+}
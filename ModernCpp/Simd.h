@@ -0,0 +1,30 @@
+#pragma once
+
+#ifndef __MODERN_CPP_SIMD_H
+#define __MODERN_CPP_SIMD_H
+
+#include <cstdint>
+
+// Runtime instruction set dispatch for the SSE2 / AVX2 kernels
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MODERNCPP_X86 1
+#endif
+
+// GCC and Clang only emit AVX2 for functions that ask for it, MSVC takes the intrinsics anywhere
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MODERNCPP_TARGET(isa)
+#else
+#define MODERNCPP_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace MODERNCPP
+{
+	enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+	// best level this CPU and OS support, probed with CPUID once
+	SimdLevel DetectSimd();
+	const char* ToString(SimdLevel level);
+}
+
+#endif
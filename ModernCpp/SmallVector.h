@@ -0,0 +1,368 @@
+#pragma once
+
+#ifndef __MODERN_CPP_SMALL_VECTOR_H
+#define __MODERN_CPP_SMALL_VECTOR_H
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <memory_resource>
+#include <initializer_list>
+
+// Vector with a small buffer: the first N elements live inside the object, only a longer
+// vector moves to the allocator. Same interface and growth as std::vector otherwise.
+// https://llvm.org/docs/ProgrammersManual.html#llvm-adt-smallvector-h
+
+namespace MODERNCPP
+{
+	// the allocator is a private base, an empty one (std::allocator) takes no room
+	template <typename T, std::size_t N, typename Alloc = std::allocator<T>>
+	class SmallVector : private Alloc {
+		static_assert(N > 0, "SmallVector needs room for at least one element inline");
+
+		using Traits = std::allocator_traits<Alloc>;
+
+	public:
+
+		using value_type = T;
+		using allocator_type = Alloc;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference = T&;
+		using const_reference = const T&;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using iterator = T*;
+		using const_iterator = const T*;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		static constexpr size_type inline_capacity = N;
+
+		SmallVector() = default;
+		explicit SmallVector(const Alloc& alloc) noexcept : Alloc(alloc) {}
+		explicit SmallVector(size_type count, const Alloc& alloc = Alloc()) : Alloc(alloc) { resize(count); }
+		SmallVector(size_type count, const T& value, const Alloc& alloc = Alloc()) : Alloc(alloc) { assign(count, value); }
+		SmallVector(std::initializer_list<T> init, const Alloc& alloc = Alloc()) : Alloc(alloc) { assign(init.begin(), init.end()); }
+
+		template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+		SmallVector(It first, It last, const Alloc& alloc = Alloc()) : Alloc(alloc) { assign(first, last); }
+
+		SmallVector(const SmallVector& other) : Alloc(Traits::select_on_container_copy_construction(other.Allocator())) { assign(other.begin(), other.end()); }
+		SmallVector(const SmallVector& other, const Alloc& alloc) : Alloc(alloc) { assign(other.begin(), other.end()); }
+
+		SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) : Alloc(std::move(other.Allocator())) { MoveFrom(other); }
+
+		// another allocator can not free the heap block, the elements move one by one then
+		SmallVector(SmallVector&& other, const Alloc& alloc) : Alloc(alloc)
+		{
+			if (Allocator() == other.Allocator())
+				MoveFrom(other);
+			else
+			{
+				assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+				other.clear();
+			}
+		}
+
+		~SmallVector()
+		{
+			clear();
+			FreeHeap();
+		}
+
+		SmallVector& operator=(const SmallVector& other)
+		{
+			if (this != &other)
+			{
+				if constexpr (Traits::propagate_on_container_copy_assignment::value)
+				{
+					if (Allocator() != other.Allocator())
+					{
+						clear();
+						FreeHeap();
+					}
+					Allocator() = other.Allocator();
+				}
+				assign(other.begin(), other.end());
+			}
+			return *this;
+		}
+
+		SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value
+			&& (Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value))
+		{
+			if (this != &other)
+			{
+				if constexpr (Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value)
+				{
+					clear();
+					FreeHeap();
+					if constexpr (Traits::propagate_on_container_move_assignment::value)
+						Allocator() = std::move(other.Allocator());
+					MoveFrom(other);
+				}
+				else if (Allocator() == other.Allocator())
+				{
+					clear();
+					FreeHeap();
+					MoveFrom(other);
+				}
+				else
+				{
+					// std::pmr: the allocator stays, only the elements move
+					assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+					other.clear();
+				}
+			}
+			return *this;
+		}
+
+		SmallVector& operator=(std::initializer_list<T> init)
+		{
+			assign(init.begin(), init.end());
+			return *this;
+		}
+
+		void assign(size_type count, const T& value)
+		{
+			clear();
+			reserve(count);
+			for (; m_size < count; ++m_size)
+				Construct(m_data + m_size, value);
+		}
+
+		template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+		void assign(It first, It last)
+		{
+			clear();
+			if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value)
+			{
+				reserve(static_cast<size_type>(std::distance(first, last)));
+				for (; first != last; ++first, ++m_size)
+					Construct(m_data + m_size, *first);
+			}
+			else
+			{
+				for (; first != last; ++first)
+					emplace_back(*first);
+			}
+		}
+
+		void assign(std::initializer_list<T> init) { assign(init.begin(), init.end()); }
+
+		iterator begin() noexcept { return m_data; }
+		iterator end() noexcept { return m_data + m_size; }
+		const_iterator begin() const noexcept { return m_data; }
+		const_iterator end() const noexcept { return m_data + m_size; }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+		reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+		reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+		bool empty() const noexcept { return m_size == 0; }
+		size_type size() const noexcept { return m_size; }
+		size_type capacity() const noexcept { return m_capacity; }
+		bool is_inline() const noexcept { return m_data == Inline(); }		// no heap block in use
+
+		allocator_type get_allocator() const noexcept { return Allocator(); }
+
+		T* data() noexcept { return m_data; }
+		const T* data() const noexcept { return m_data; }
+
+		T& operator[](size_type i) { return m_data[i]; }
+		const T& operator[](size_type i) const { return m_data[i]; }
+
+		T& at(size_type i) { return const_cast<T&>(static_cast<const SmallVector&>(*this).at(i)); }
+		const T& at(size_type i) const
+		{
+			if (i >= m_size)
+				throw std::out_of_range("SmallVector::at");
+			return m_data[i];
+		}
+
+		T& front() { return m_data[0]; }
+		const T& front() const { return m_data[0]; }
+		T& back() { return m_data[m_size - 1]; }
+		const T& back() const { return m_data[m_size - 1]; }
+
+		void reserve(size_type capacity)
+		{
+			if (capacity > m_capacity)
+				Relocate(capacity);
+		}
+
+		// back into the inline buffer if the elements fit there
+		void shrink_to_fit()
+		{
+			if (!is_inline() && m_size < m_capacity)
+				Relocate(m_size);
+		}
+
+		void clear() noexcept
+		{
+			Destroy(m_data, m_data + m_size);
+			m_size = 0;
+		}
+
+		void push_back(const T& value) { emplace_back(value); }
+		void push_back(T&& value) { emplace_back(std::move(value)); }
+
+		template <typename... Args>
+		T& emplace_back(Args&&... args)
+		{
+			if (m_size == m_capacity)
+			{
+				// the argument may live in this vector, construct it before the old block goes away
+				T value(std::forward<Args>(args)...);
+				Relocate(Grown(m_size + 1));
+				Construct(m_data + m_size, std::move(value));
+			}
+			else
+				Construct(m_data + m_size, std::forward<Args>(args)...);
+			return m_data[m_size++];
+		}
+
+		void pop_back()
+		{
+			--m_size;
+			Destroy(m_data + m_size, m_data + m_size + 1);
+		}
+
+		void resize(size_type count) { Resize(count, [this](T* p) { Construct(p); }); }
+		void resize(size_type count, const T& value) { Resize(count, [this, &value](T* p) { Construct(p, value); }); }
+
+		iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			T* f = m_data + (first - m_data);
+			T* l = m_data + (last - m_data);
+			if (f != l)
+			{
+				T* newEnd = std::move(l, end(), f);
+				Destroy(newEnd, end());
+				m_size = static_cast<size_type>(newEnd - m_data);
+			}
+			return f;
+		}
+
+		iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+		iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+		template <typename... Args>
+		iterator emplace(const_iterator pos, Args&&... args)
+		{
+			const size_type i = static_cast<size_type>(pos - m_data);
+			emplace_back(std::forward<Args>(args)...);
+			std::rotate(m_data + i, m_data + m_size - 1, m_data + m_size);
+			return m_data + i;
+		}
+
+		friend bool operator==(const SmallVector& a, const SmallVector& b) { return std::equal(a.begin(), a.end(), b.begin(), b.end()); }
+		friend bool operator!=(const SmallVector& a, const SmallVector& b) { return !(a == b); }
+
+	private:
+
+		Alloc& Allocator() noexcept { return *this; }
+		const Alloc& Allocator() const noexcept { return *this; }
+
+		// through the allocator, std::pmr hands its resource on to elements that take one
+		template <typename... Args>
+		void Construct(T* p, Args&&... args) { Traits::construct(Allocator(), p, std::forward<Args>(args)...); }
+		void Destroy(T* first, T* last) noexcept
+		{
+			for (; first != last; ++first)
+				Traits::destroy(Allocator(), first);
+		}
+
+		T* Inline() noexcept { return std::launder(reinterpret_cast<T*>(m_inline)); }
+		const T* Inline() const noexcept { return std::launder(reinterpret_cast<const T*>(m_inline)); }
+
+		size_type Grown(size_type needed) const { return (std::max)(needed, 2 * m_capacity); }
+
+		// moves the elements to a block of the given capacity, the inline buffer if they fit
+		void Relocate(size_type capacity)
+		{
+			T* block = capacity <= N ? Inline() : Traits::allocate(Allocator(), capacity);
+			if (block == m_data)
+				return;
+			size_type built = 0;
+			try
+			{
+				for (; built < m_size; ++built)
+					Construct(block + built, std::move_if_noexcept(m_data[built]));
+			}
+			catch (...)
+			{
+				Destroy(block, block + built);
+				if (block != Inline())
+					Traits::deallocate(Allocator(), block, capacity);
+				throw;
+			}
+			Destroy(m_data, m_data + m_size);
+			FreeHeap();
+			m_data = block;
+			m_capacity = capacity <= N ? N : capacity;
+		}
+
+		template <typename Construct>
+		void Resize(size_type count, Construct&& construct)
+		{
+			if (count < m_size)
+			{
+				Destroy(m_data + count, m_data + m_size);
+				m_size = count;
+				return;
+			}
+			reserve(count);
+			for (; m_size < count; ++m_size)
+				construct(m_data + m_size);
+		}
+
+		void FreeHeap() noexcept
+		{
+			if (!is_inline())
+				Traits::deallocate(Allocator(), m_data, m_capacity);
+			m_data = Inline();
+			m_capacity = N;
+		}
+
+		// a heap block changes hands, inline elements are moved one by one
+		void MoveFrom(SmallVector& other)
+		{
+			if (other.is_inline())
+			{
+				for (; m_size < other.m_size; ++m_size)
+					Construct(m_data + m_size, std::move(other.m_data[m_size]));
+				other.clear();
+			}
+			else
+			{
+				m_data = std::exchange(other.m_data, other.Inline());
+				m_size = std::exchange(other.m_size, 0);
+				m_capacity = std::exchange(other.m_capacity, N);
+			}
+		}
+
+		alignas(T) unsigned char m_inline[N * sizeof(T)];
+		T* m_data = Inline();
+		size_type m_size = 0;
+		size_type m_capacity = N;
+	};
+
+	namespace PMR
+	{
+		// like std::pmr::vector, spills to the memory resource it was given
+		template <typename T, std::size_t N>
+		using SmallVector = MODERNCPP::SmallVector<T, N, std::pmr::polymorphic_allocator<T>>;
+	}
+}
+
+#endif
@@ -0,0 +1,347 @@
+#include "pch.h"
+#include "SpecialMath.h"
+#include "ThreadPool.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <exception>
+#include <algorithm>
+
+#ifdef MODERNCPP_X86
+#include <immintrin.h>
+#endif
+
+namespace MODERNCPP::BATCH
+{
+	namespace
+	{
+		const double nan = std::numeric_limits<double>::quiet_NaN();
+		const double inf = std::numeric_limits<double>::infinity();
+
+		struct Step {
+			double a, b, c;
+		};
+
+		// P[k + 1] = (a x + b) P[k] - c P[k - 1], from P[-1] = 0 and P[0] = scale * sqrt(1 - x^2)^m.
+		// No fused multiply-add, so the scalar and the SIMD kernels round alike.
+		struct Recurrence {
+			std::vector<Step> steps;
+			double scale = 1;
+			unsigned m = 0;
+			double lo = -inf, hi = inf;		// the domain, NaN outside it
+
+			bool bounded() const { return lo != -inf || hi != inf; }
+		};
+
+		double StartScalar(const Recurrence& r, double x)
+		{
+			double p = r.scale;
+			if (r.m)
+			{
+				const double root = std::sqrt(1 - x) * std::sqrt(1 + x);
+				for (unsigned i = 0; i < r.m; ++i)
+					p *= root;
+			}
+			return p;
+		}
+
+		void RunScalar(const Recurrence& r, const double* x, double* out, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const double xi = x[i];
+				double prev = 0, p = StartScalar(r, xi);
+				for (const Step& s : r.steps)
+				{
+					const double next = (s.a * xi + s.b) * p - s.c * prev;
+					prev = p;
+					p = next;
+				}
+				out[i] = xi < r.lo || xi > r.hi ? nan : p;
+			}
+		}
+
+#ifdef MODERNCPP_X86
+		// a step is a chain of multiply, multiply and subtract, four registers in flight hide its latency
+		const std::size_t unroll = 4;
+
+		MODERNCPP_TARGET("sse2")
+		inline __m128d StartSSE2(const Recurrence& r, __m128d x)
+		{
+			__m128d p = _mm_set1_pd(r.scale);
+			if (r.m)
+			{
+				const __m128d one = _mm_set1_pd(1.0);
+				const __m128d root = _mm_mul_pd(_mm_sqrt_pd(_mm_sub_pd(one, x)), _mm_sqrt_pd(_mm_add_pd(one, x)));
+				for (unsigned i = 0; i < r.m; ++i)
+					p = _mm_mul_pd(p, root);
+			}
+			return p;
+		}
+
+		MODERNCPP_TARGET("sse2")
+		inline __m128d BoundSSE2(const Recurrence& r, __m128d x, __m128d p)
+		{
+			if (!r.bounded())
+				return p;
+			const __m128d inside = _mm_and_pd(_mm_cmpge_pd(x, _mm_set1_pd(r.lo)), _mm_cmple_pd(x, _mm_set1_pd(r.hi)));
+			return _mm_or_pd(_mm_and_pd(inside, p), _mm_andnot_pd(inside, _mm_set1_pd(nan)));
+		}
+
+		// returns how many points it did, the scalar kernel takes the rest
+		MODERNCPP_TARGET("sse2")
+		std::size_t RunSSE2(const Recurrence& r, const double* x, double* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 2 * unroll <= count; i += 2 * unroll)
+			{
+				__m128d xv[unroll], prev[unroll], p[unroll];
+				for (std::size_t j = 0; j < unroll; ++j)
+				{
+					xv[j] = _mm_loadu_pd(x + i + 2 * j);
+					prev[j] = _mm_setzero_pd();
+					p[j] = StartSSE2(r, xv[j]);
+				}
+				for (const Step& s : r.steps)
+				{
+					const __m128d a = _mm_set1_pd(s.a), b = _mm_set1_pd(s.b), c = _mm_set1_pd(s.c);
+					for (std::size_t j = 0; j < unroll; ++j)
+					{
+						const __m128d next = _mm_sub_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(a, xv[j]), b), p[j]), _mm_mul_pd(c, prev[j]));
+						prev[j] = p[j];
+						p[j] = next;
+					}
+				}
+				for (std::size_t j = 0; j < unroll; ++j)
+					_mm_storeu_pd(out + i + 2 * j, BoundSSE2(r, xv[j], p[j]));
+			}
+			return i;
+		}
+
+		MODERNCPP_TARGET("avx2")
+		inline __m256d StartAVX2(const Recurrence& r, __m256d x)
+		{
+			__m256d p = _mm256_set1_pd(r.scale);
+			if (r.m)
+			{
+				const __m256d one = _mm256_set1_pd(1.0);
+				const __m256d root = _mm256_mul_pd(_mm256_sqrt_pd(_mm256_sub_pd(one, x)), _mm256_sqrt_pd(_mm256_add_pd(one, x)));
+				for (unsigned i = 0; i < r.m; ++i)
+					p = _mm256_mul_pd(p, root);
+			}
+			return p;
+		}
+
+		MODERNCPP_TARGET("avx2")
+		inline __m256d BoundAVX2(const Recurrence& r, __m256d x, __m256d p)
+		{
+			if (!r.bounded())
+				return p;
+			const __m256d inside = _mm256_and_pd(_mm256_cmp_pd(x, _mm256_set1_pd(r.lo), _CMP_GE_OQ), _mm256_cmp_pd(x, _mm256_set1_pd(r.hi), _CMP_LE_OQ));
+			return _mm256_blendv_pd(_mm256_set1_pd(nan), p, inside);
+		}
+
+		MODERNCPP_TARGET("avx2")
+		std::size_t RunAVX2(const Recurrence& r, const double* x, double* out, std::size_t count)
+		{
+			std::size_t i = 0;
+			for (; i + 4 * unroll <= count; i += 4 * unroll)
+			{
+				__m256d xv[unroll], prev[unroll], p[unroll];
+				for (std::size_t j = 0; j < unroll; ++j)
+				{
+					xv[j] = _mm256_loadu_pd(x + i + 4 * j);
+					prev[j] = _mm256_setzero_pd();
+					p[j] = StartAVX2(r, xv[j]);
+				}
+				for (const Step& s : r.steps)
+				{
+					const __m256d a = _mm256_broadcast_sd(&s.a), b = _mm256_broadcast_sd(&s.b), c = _mm256_broadcast_sd(&s.c);
+					for (std::size_t j = 0; j < unroll; ++j)
+					{
+						const __m256d next = _mm256_sub_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(a, xv[j]), b), p[j]), _mm256_mul_pd(c, prev[j]));
+						prev[j] = p[j];
+						p[j] = next;
+					}
+				}
+				for (std::size_t j = 0; j < unroll; ++j)
+					_mm256_storeu_pd(out + i + 4 * j, BoundAVX2(r, xv[j], p[j]));
+			}
+			return i;
+		}
+#endif
+
+		void Run(const Recurrence& r, const double* x, double* out, std::size_t count, SimdLevel level)
+		{
+			std::size_t done = 0;
+#ifdef MODERNCPP_X86
+			level = (std::min)(level, DetectSimd());
+			if (level == SimdLevel::AVX2)
+				done = RunAVX2(r, x, out, count);
+			else if (level == SimdLevel::SSE2)
+				done = RunSSE2(r, x, out, count);
+#else
+			(void)level;
+#endif
+			RunScalar(r, x + done, out + done, count - done);
+		}
+
+		// L(n, m) steps k = 0 .. n - 1: (k + 1) L[k + 1] = (2k + 1 + m - x) L[k] - (k + m) L[k - 1]
+		// x < 0 gives NaN, libstdc++ throws std::domain_error there
+		Recurrence LaguerreSteps(unsigned n, unsigned m)
+		{
+			Recurrence r;
+			r.lo = 0;
+			for (unsigned k = 0; k < n; ++k)
+				r.steps.push_back({ -1.0 / (k + 1), double(2 * k + 1 + m) / (k + 1), double(k + m) / (k + 1) });
+			return r;
+		}
+
+		// a point out of the domain gives NaN rather than ending the whole batch
+		template <typename F>
+		void Chunked(const double* x, double* out, std::size_t count, F f)
+		{
+			const std::size_t grain = 256;		// points per task, tens of microseconds of std:: calls
+			ThreadPool::Instance().parallel_for(0, count, [x, out, &f](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; ++i)
+				{
+					try { out[i] = f(x[i]); }
+					catch (const std::exception&) { out[i] = nan; }
+				}
+			}, grain);
+		}
+	}
+
+	// (k + 1) P[k + 1] = (2k + 1) x P[k] - k P[k - 1]
+	// |x| > 1 is out of the domain and gives NaN, libstdc++ extrapolates the polynomial there
+	void Legendre(unsigned n, const double* x, double* out, std::size_t count, SimdLevel level)
+	{
+		Recurrence r;
+		r.lo = -1;
+		r.hi = 1;
+		for (unsigned k = 0; k < n; ++k)
+			r.steps.push_back({ double(2 * k + 1) / (k + 1), 0.0, double(k) / (k + 1) });
+		Run(r, x, out, count, level);
+	}
+
+	// P(m, m) = (2m - 1)!! (1 - x^2)^(m / 2), no Condon-Shortley phase, as std::assoc_legendre
+	// (l - m + 1) P(l + 1, m) = (2l + 1) x P(l, m) - (l + m) P(l - 1, m)
+	// |x| > 1 gives NaN for every m, as for Legendre; m > l gives 0 inside, as libstdc++ does
+	void AssocLegendre(unsigned l, unsigned m, const double* x, double* out, std::size_t count, SimdLevel level)
+	{
+		Recurrence r;
+		r.lo = -1;
+		r.hi = 1;
+		if (m > l)
+			r.scale = 0;
+		else
+		{
+			r.m = m;
+			for (unsigned i = 1; i <= m; ++i)
+				r.scale *= 2 * i - 1;
+			for (unsigned k = 0; k < l - m; ++k)
+				r.steps.push_back({ double(2 * (m + k) + 1) / (k + 1), 0.0, double(2 * m + k) / (k + 1) });
+		}
+		Run(r, x, out, count, level);
+	}
+
+	void Laguerre(unsigned n, const double* x, double* out, std::size_t count, SimdLevel level)
+	{
+		Run(LaguerreSteps(n, 0), x, out, count, level);
+	}
+
+	void AssocLaguerre(unsigned n, unsigned m, const double* x, double* out, std::size_t count, SimdLevel level)
+	{
+		Run(LaguerreSteps(n, m), x, out, count, level);
+	}
+
+	// H[k + 1] = 2x H[k] - 2k H[k - 1]
+	void Hermite(unsigned n, const double* x, double* out, std::size_t count, SimdLevel level)
+	{
+		Recurrence r;
+		for (unsigned k = 0; k < n; ++k)
+			r.steps.push_back({ 2.0, 0.0, 2.0 * k });
+		Run(r, x, out, count, level);
+	}
+
+	void Beta(double x, const double* y, double* out, std::size_t count)
+	{
+		Chunked(y, out, count, [x](double v) { return std::beta(x, v); });
+	}
+
+	void CompEllint1(const double* k, double* out, std::size_t count)
+	{
+		Chunked(k, out, count, [](double v) { return std::comp_ellint_1(v); });
+	}
+
+	void CompEllint2(const double* k, double* out, std::size_t count)
+	{
+		Chunked(k, out, count, [](double v) { return std::comp_ellint_2(v); });
+	}
+
+	void CompEllint3(double k, const double* nu, double* out, std::size_t count)
+	{
+		Chunked(nu, out, count, [k](double v) { return std::comp_ellint_3(k, v); });
+	}
+
+	void Ellint1(double k, const double* phi, double* out, std::size_t count)
+	{
+		Chunked(phi, out, count, [k](double v) { return std::ellint_1(k, v); });
+	}
+
+	void Ellint2(double k, const double* phi, double* out, std::size_t count)
+	{
+		Chunked(phi, out, count, [k](double v) { return std::ellint_2(k, v); });
+	}
+
+	void Ellint3(double k, double nu, const double* phi, double* out, std::size_t count)
+	{
+		Chunked(phi, out, count, [k, nu](double v) { return std::ellint_3(k, nu, v); });
+	}
+
+	void CylBesselI(double nu, const double* x, double* out, std::size_t count)
+	{
+		Chunked(x, out, count, [nu](double v) { return std::cyl_bessel_i(nu, v); });
+	}
+
+	void CylBesselJ(double nu, const double* x, double* out, std::size_t count)
+	{
+		Chunked(x, out, count, [nu](double v) { return std::cyl_bessel_j(nu, v); });
+	}
+
+	void CylBesselK(double nu, const double* x, double* out, std::size_t count)
+	{
+		Chunked(x, out, count, [nu](double v) { return std::cyl_bessel_k(nu, v); });
+	}
+
+	void CylNeumann(double nu, const double* x, double* out, std::size_t count)
+	{
+		Chunked(x, out, count, [nu](double v) { return std::cyl_neumann(nu, v); });
+	}
+
+	void SphBessel(unsigned n, const double* x, double* out, std::size_t count)
+	{
+		Chunked(x, out, count, [n](double v) { return std::sph_bessel(n, v); });
+	}
+
+	void SphNeumann(unsigned n, const double* x, double* out, std::size_t count)
+	{
+		Chunked(x, out, count, [n](double v) { return std::sph_neumann(n, v); });
+	}
+
+	void SphLegendre(unsigned l, unsigned m, const double* theta, double* out, std::size_t count)
+	{
+		Chunked(theta, out, count, [l, m](double v) { return std::sph_legendre(l, m, v); });
+	}
+
+	void Expint(const double* x, double* out, std::size_t count)
+	{
+		Chunked(x, out, count, [](double v) { return std::expint(v); });
+	}
+
+	void RiemannZeta(const double* x, double* out, std::size_t count)
+	{
+		Chunked(x, out, count, [](double v) { return std::riemann_zeta(v); });
+	}
+}
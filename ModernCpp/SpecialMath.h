@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef __MODERN_CPP_SPECIAL_MATH_H
+#define __MODERN_CPP_SPECIAL_MATH_H
+
+#include "Simd.h"
+
+#include <cstddef>
+
+// C++17's special math functions over arrays of points: out[i] = std::f(..., x[i]) for i < count.
+// C++17 has no std::span, a pointer and a count take its place; x and out may be the same array.
+//
+// Legendre, Laguerre and Hermite polynomials (and their associated forms) run their three-term
+// recurrences on 4 (AVX2) or 2 (SSE2) points at once, every level gives the same bits and std::
+// agrees to rounding. The other functions have no cheap recurrence, they call std:: on chunks of
+// points spread over the ThreadPool.
+// Points out of a function's domain in the standard give NaN: |x| > 1 for the Legendre functions,
+// x < 0 for Laguerre, where libstdc++ extrapolates or throws std::domain_error.
+// https://dlmf.nist.gov/18.9		(recurrences of the classical orthogonal polynomials)
+
+namespace MODERNCPP::BATCH
+{
+	// three-term recurrences, SIMD
+	void Legendre(unsigned n, const double* x, double* out, std::size_t count, SimdLevel level = DetectSimd());
+	void AssocLegendre(unsigned l, unsigned m, const double* x, double* out, std::size_t count, SimdLevel level = DetectSimd());
+	void Laguerre(unsigned n, const double* x, double* out, std::size_t count, SimdLevel level = DetectSimd());
+	void AssocLaguerre(unsigned n, unsigned m, const double* x, double* out, std::size_t count, SimdLevel level = DetectSimd());
+	void Hermite(unsigned n, const double* x, double* out, std::size_t count, SimdLevel level = DetectSimd());
+
+	// std:: per point, in parallel chunks
+	void Beta(double x, const double* y, double* out, std::size_t count);
+	void CompEllint1(const double* k, double* out, std::size_t count);
+	void CompEllint2(const double* k, double* out, std::size_t count);
+	void CompEllint3(double k, const double* nu, double* out, std::size_t count);
+	void Ellint1(double k, const double* phi, double* out, std::size_t count);
+	void Ellint2(double k, const double* phi, double* out, std::size_t count);
+	void Ellint3(double k, double nu, const double* phi, double* out, std::size_t count);
+	void CylBesselI(double nu, const double* x, double* out, std::size_t count);
+	void CylBesselJ(double nu, const double* x, double* out, std::size_t count);
+	void CylBesselK(double nu, const double* x, double* out, std::size_t count);
+	void CylNeumann(double nu, const double* x, double* out, std::size_t count);
+	void SphBessel(unsigned n, const double* x, double* out, std::size_t count);
+	void SphNeumann(unsigned n, const double* x, double* out, std::size_t count);
+	void SphLegendre(unsigned l, unsigned m, const double* theta, double* out, std::size_t count);
+	void Expint(const double* x, double* out, std::size_t count);
+	void RiemannZeta(const double* x, double* out, std::size_t count);
+}
+
+#endif
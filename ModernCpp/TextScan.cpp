@@ -0,0 +1,102 @@
+#include "pch.h"
+#include "TextScan.h"
+#include "MappedFile.h"
+#include "Tokenizer.h"
+#include "Regex.h"
+
+#include <algorithm>
+
+namespace MODERNCPP
+{
+	namespace
+	{
+		const std::size_t max_line = 64 * 1024;		// how far past a chunk a line end is looked for
+
+		TextStats ScanChunk(std::string_view chunk, const DfaRegex& pattern, std::size_t longer)
+		{
+			TextStats stats;
+			stats.bytes = chunk.size();
+
+			WordTokenizer words(chunk);
+			for (std::string_view word; words.next(word); )
+			{
+				++stats.words;
+				if (word.size() > longer)
+					stats.longWords.push_back(word);
+			}
+
+			DfaRegex::Match m;
+			for (std::size_t from = 0; from <= chunk.size() && pattern.search(chunk, m, from); )
+			{
+				++stats.matches;
+				from = m.position + (m.length ? m.length : 1);
+			}
+			return stats;
+		}
+
+		TextStats Merge(const std::vector<TextStats>& parts)
+		{
+			TextStats total;
+			std::size_t words = 0;
+			for (const TextStats& part : parts)
+				words += part.longWords.size();
+			total.longWords.reserve(words);
+			for (const TextStats& part : parts)
+				total += part;
+			return total;
+		}
+	}
+
+	std::vector<std::string_view> SplitChunks(std::string_view text, std::size_t chunk)
+	{
+		chunk = (std::max)(chunk, std::size_t(1));
+		std::vector<std::string_view> chunks;
+		chunks.reserve(text.size() / chunk + 1);
+
+		for (std::size_t begin = 0; begin < text.size();)
+		{
+			std::size_t end = begin + chunk;
+			if (end >= text.size())
+				end = text.size();
+			else
+			{
+				const std::size_t limit = (std::min)(end + max_line, text.size());
+				const std::string_view tail = text.substr(end - 1, limit - end + 1);
+				std::size_t cut = tail.find('\n');
+				if (cut == std::string_view::npos)
+					cut = tail.find_first_of(" \t\n\v\f\r");
+				end = cut == std::string_view::npos ? limit : end + cut;
+			}
+			chunks.push_back(text.substr(begin, end - begin));
+			begin = end;
+		}
+		return chunks;
+	}
+
+	TextStats& TextStats::operator+=(const TextStats& b)
+	{
+		bytes += b.bytes;
+		words += b.words;
+		matches += b.matches;
+		longWords.insert(longWords.end(), b.longWords.begin(), b.longWords.end());
+		return *this;
+	}
+
+	TextStats ScanText(std::string_view text, const DfaRegex& pattern, std::size_t longer, std::size_t chunk)
+	{
+		return Merge(MapChunks<TextStats>(SplitChunks(text, chunk), [&](std::string_view part) {
+			return ScanChunk(part, pattern, longer);
+		}));
+	}
+
+	TextStats ScanText(const MappedFile& file, const DfaRegex& pattern, std::size_t longer, std::size_t chunk)
+	{
+		return Merge(MapChunks<TextStats>(SplitChunks(file.view(), chunk), [&](std::string_view part) {
+			const std::size_t offset = static_cast<std::size_t>(part.data() - file.data());
+			file.prefetch(offset, part.size());
+			TextStats stats = ScanChunk(part, pattern, longer);
+			file.release(offset, part.size());
+			return stats;
+		}));
+	}
+}
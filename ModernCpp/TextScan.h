@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef __MODERN_CPP_TEXT_SCAN_H
+#define __MODERN_CPP_TEXT_SCAN_H
+
+#include "ThreadPool.h"
+
+#include <vector>
+#include <cstddef>
+#include <string_view>
+
+// Text scanned in chunks on the ThreadPool: the text is cut at line ends into chunks of a few MB,
+// every chunk is scanned on its own and the partial results are merged in chunk order. A match can
+// not cross a chunk boundary, so a pattern must not span lines, as with grep.
+//
+//   MappedFile log("big.log");
+//   TextStats stats = ScanText(log, cache.Dfa("timeout"), 12);
+
+namespace MODERNCPP
+{
+	class DfaRegex;
+	class MappedFile;
+
+	// [begin, end) pieces of text of about chunk bytes, each ends after a '\n'. A line longer than
+	// 64 KB past chunk is cut after whitespace, with neither it is cut where it is.
+	std::vector<std::string_view> SplitChunks(std::string_view text, std::size_t chunk);
+
+	// map(chunk) on every chunk in parallel, the results in chunk order. The first exception of map is
+	// rethrown once the chunks running have finished, as parallel_for does.
+	template <typename R, typename F>
+	std::vector<R> MapChunks(const std::vector<std::string_view>& chunks, F&& map)
+	{
+		std::vector<R> results(chunks.size());
+		ThreadPool::Instance().parallel_for(0, chunks.size(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i)
+				results[i] = map(chunks[i]);
+		}, 1);
+		return results;
+	}
+
+	struct TextStats {
+		std::size_t bytes = 0;
+		std::size_t words = 0;							// as WordTokenizer splits them
+		std::size_t matches = 0;						// non-overlapping matches of the pattern
+		std::vector<std::string_view> longWords;		// words longer than the limit, in text order
+
+		// the merge step: counts add up, b's words follow this one's
+		TextStats& operator+=(const TextStats& b);
+	};
+
+	inline constexpr std::size_t default_chunk = std::size_t(4) << 20;
+
+	// the words point into text
+	TextStats ScanText(std::string_view text, const DfaRegex& pattern, std::size_t longer, std::size_t chunk = default_chunk);
+
+	// the words point into the mapping; each chunk is prefetched before it is scanned and released
+	// after, the resident set stays near a chunk per thread however large the file is
+	TextStats ScanText(const MappedFile& file, const DfaRegex& pattern, std::size_t longer, std::size_t chunk = default_chunk);
+}
+
+#endif
@@ -0,0 +1,203 @@
+#include "pch.h"
+#include "ThreadPool.h"
+#include "Cpp11.h"
+
+#include <chrono>
+#include <climits>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")		// WaitOnAddress / WakeByAddress*
+#endif
+
+namespace MODERNCPP
+{
+	namespace
+	{
+		static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+			"futex word must be a plain 32-bit integer");
+
+		// block while *word == expected, spurious wake ups are fine
+		void FutexWait(std::atomic<std::uint32_t>* word, std::uint32_t expected)
+		{
+#if defined(__linux__)
+			syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+			WaitOnAddress(word, &expected, sizeof(expected), INFINITE);
+#else
+			while (word->load(std::memory_order_acquire) == expected)
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+#endif
+		}
+
+		void FutexWake(std::atomic<std::uint32_t>* word, bool all)
+		{
+#if defined(__linux__)
+			syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+			if (all)
+				WakeByAddressAll(word);
+			else
+				WakeByAddressSingle(word);
+#else
+			(void)word; (void)all;
+#endif
+		}
+
+		// which pool (if any) the current thread works for
+		thread_local ThreadPool* t_pool = nullptr;
+		thread_local unsigned t_index = 0;
+
+		// cheap victim selection for stealing
+		unsigned NextRandom()
+		{
+			thread_local std::uint32_t state =
+				static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+	}
+
+	struct ThreadPool::Worker {
+		WorkStealingDeque<Task*> deque;
+		std::thread thread;
+	};
+
+	ThreadPool::ThreadPool(unsigned nthreads)
+		: m_injected(1024)
+	{
+		if (nthreads == 0)
+			nthreads = 1;
+
+		// every deque must exist before any worker starts stealing
+		for (unsigned i = 0; i < nthreads; ++i)
+			m_workers.emplace_back(new Worker);
+		for (unsigned i = 0; i < nthreads; ++i)
+			m_workers[i]->thread = std::thread([this, i] { WorkerLoop(i); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		m_stop.store(true, std::memory_order_release);
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+		FutexWake(&m_epoch, true);
+
+		for (auto& w : m_workers)
+			w->thread.join();
+	}
+
+	ThreadPool& ThreadPool::Instance()
+	{
+		static ThreadPool pool;		// C++11, thread safe initialization
+		return pool;
+	}
+
+	void ThreadPool::post(Task task)
+	{
+		Task* t = new Task(std::move(task));
+
+		if (t_pool == this)
+			m_workers[t_index]->deque.push(t);		// stays hot in this worker's cache
+		else if (!m_injected.try_push(t))
+		{
+			Run(t);									// injection queue is full, the caller runs it
+			return;
+		}
+		WakeOne();
+	}
+
+	void ThreadPool::WakeOne()
+	{
+		// pairs with the sleepers/epoch sequence in WorkerLoop, seq_cst so neither side misses the other
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+		if (m_sleepers.load(std::memory_order_seq_cst) != 0)
+			FutexWake(&m_epoch, false);
+	}
+
+	void ThreadPool::Run(Task* task)
+	{
+		IGNORE_EXCEPTION((*task));		// posted tasks are fire and forget, submit() keeps its exceptions
+		delete task;
+	}
+
+	ThreadPool::Task* ThreadPool::FindTask(unsigned self)
+	{
+		const unsigned n = size();
+
+		if (self < n)
+			if (Task* t = m_workers[self]->deque.pop())
+				return t;
+
+		Task* t = nullptr;
+		if (m_injected.try_pop(t))
+			return t;
+
+		const unsigned start = NextRandom() % n;
+		for (unsigned i = 0; i < n; ++i)
+		{
+			const unsigned victim = (start + i) % n;
+			if (victim != self)
+				if (Task* stolen = m_workers[victim]->deque.steal())
+					return stolen;
+		}
+		return nullptr;
+	}
+
+	void ThreadPool::WorkerLoop(unsigned index)
+	{
+		t_pool = this;
+		t_index = index;
+
+		for (;;)
+		{
+			Task* t = FindTask(index);
+			for (int spin = 0; !t && spin < 64; ++spin)		// a short spin before paying for a syscall
+			{
+				std::this_thread::yield();
+				t = FindTask(index);
+			}
+			if (t)
+			{
+				Run(t);
+				continue;
+			}
+
+			m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+			const std::uint32_t epoch = m_epoch.load(std::memory_order_seq_cst);
+			if ((t = FindTask(index)) == nullptr)
+			{
+				if (m_stop.load(std::memory_order_acquire))
+				{
+					m_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+					break;			// drained and asked to stop
+				}
+				FutexWait(&m_epoch, epoch);
+			}
+			m_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+
+			if (t)
+				Run(t);
+		}
+
+		t_pool = nullptr;
+	}
+
+	void ThreadPool::help_while(const std::function<bool()>& busy)
+	{
+		const unsigned self = t_pool == this ? t_index : size();
+		while (busy())
+		{
+			if (Task* t = FindTask(self))
+				Run(t);
+			else
+				std::this_thread::yield();
+		}
+	}
+}
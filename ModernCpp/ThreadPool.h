@@ -0,0 +1,257 @@
+#pragma once
+
+#ifndef __MODERN_CPP_THREAD_POOL_H
+#define __MODERN_CPP_THREAD_POOL_H
+
+#include "RingBuffer.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <future>
+#include <cstdint>
+#include <exception>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+// Persistent work-stealing thread pool
+// https://www.dre.vanderbilt.edu/~schmidt/PDF/work-stealing-dequeue.pdf	(Chase & Lev)
+// https://fzn.fr/readings/ppopp13.pdf									(C11 memory orderings)
+
+namespace MODERNCPP
+{
+	// Chase-Lev deque: the owning worker pushes and pops at the bottom without any
+	// read-modify-write, thieves take from the top with a single CAS.
+	template <typename T>
+	class WorkStealingDeque {
+		static_assert(std::is_pointer<T>::value, "WorkStealingDeque stores pointers");
+
+	public:
+
+		explicit WorkStealingDeque(std::int64_t capacity = 256)
+			: m_array(new Array(static_cast<std::int64_t>(ceil_pow2(static_cast<std::size_t>(capacity)))))
+		{}
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		~WorkStealingDeque() { delete m_array.load(std::memory_order_relaxed); }
+
+		// owner only
+		void push(T item)
+		{
+			const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+			const std::int64_t t = m_top.load(std::memory_order_acquire);
+			Array* a = m_array.load(std::memory_order_relaxed);
+			if (b - t > a->capacity - 1)
+			{
+				// full, thieves may still be reading the old array so keep it until we die
+				Array* bigger = a->grow(b, t);
+				m_retired.emplace_back(a);
+				m_array.store(bigger, std::memory_order_release);
+				a = bigger;
+			}
+			a->put(b, item);
+			m_bottom.store(b + 1, std::memory_order_release);		// publishes the item to thieves
+		}
+
+		// owner only, nullptr when empty
+		T pop()
+		{
+			const std::int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+			Array* a = m_array.load(std::memory_order_relaxed);
+			m_bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			std::int64_t t = m_top.load(std::memory_order_relaxed);
+
+			T item = nullptr;
+			if (t <= b)
+			{
+				item = a->get(b);
+				if (t == b)
+				{
+					// last element, race the thieves for it
+					if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						item = nullptr;
+					m_bottom.store(b + 1, std::memory_order_relaxed);
+				}
+			}
+			else
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+			return item;
+		}
+
+		// any thread, nullptr when empty or when another thief won
+		T steal()
+		{
+			std::int64_t t = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const std::int64_t b = m_bottom.load(std::memory_order_acquire);
+
+			T item = nullptr;
+			if (t < b)
+			{
+				Array* a = m_array.load(std::memory_order_acquire);
+				item = a->get(t);
+				if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return nullptr;
+			}
+			return item;
+		}
+
+		bool empty() const
+		{
+			return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+		}
+
+	private:
+
+		struct Array {
+			explicit Array(std::int64_t cap) : capacity(cap), mask(cap - 1), data(new std::atomic<T>[cap]) {}
+
+			T get(std::int64_t i) const { return data[i & mask].load(std::memory_order_relaxed); }
+			void put(std::int64_t i, T v) { data[i & mask].store(v, std::memory_order_relaxed); }
+
+			Array* grow(std::int64_t b, std::int64_t t) const
+			{
+				Array* a = new Array(capacity * 2);
+				for (std::int64_t i = t; i != b; ++i)
+					a->put(i, get(i));
+				return a;
+			}
+
+			const std::int64_t capacity;
+			const std::int64_t mask;
+			const std::unique_ptr<std::atomic<T>[]> data;
+		};
+
+		alignas(cache_line_size) std::atomic<std::int64_t> m_top{ 0 };
+		alignas(cache_line_size) std::atomic<std::int64_t> m_bottom{ 0 };
+		std::atomic<Array*> m_array;
+		std::vector<std::unique_ptr<Array>> m_retired;		// owner only
+	};
+
+	class ThreadPool {
+	public:
+
+		using Task = std::function<void()>;
+
+		explicit ThreadPool(unsigned nthreads = std::thread::hardware_concurrency());
+		~ThreadPool();												// runs every queued task, then joins
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		static ThreadPool& Instance();								// process wide pool, one worker per core
+
+		unsigned size() const { return static_cast<unsigned>(m_workers.size()); }
+
+		// fire and forget
+		void post(Task task);
+
+		// run f(args...) on the pool, the future carries its result or exception
+		template <typename F, typename... Args>
+		auto submit(F&& f, Args&&... args)
+			-> std::future<std::invoke_result_t<F, Args...>>
+		{
+			using R = std::invoke_result_t<F, Args...>;
+			auto job = std::make_shared<std::packaged_task<R()>>(
+				std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+			std::future<R> result = job->get_future();
+			post([job] { (*job)(); });
+			return result;
+		}
+
+		// runs queued tasks on the calling thread until busy() turns false, for whoever posted
+		// work and now waits for it; safe from inside a pool task, like parallel_for
+		void help_while(const std::function<bool()>& busy);
+
+		// body(bi, ei) over [first, last) split into chunks of at most grain items (0 = pick one).
+		// The caller runs chunks too, so this is safe to call from inside a pool task. Once body
+		// throws the chunks not started yet are skipped, the first exception is rethrown when the
+		// ones running have finished.
+		template <typename F>
+		void parallel_for(std::size_t first, std::size_t last, F&& body, std::size_t grain = 0)
+		{
+			if (first >= last)
+				return;
+
+			const std::size_t n = last - first;
+			if (grain == 0)
+				grain = (std::max)(std::size_t(1), n / (4 * (size() + 1)));
+			const std::size_t nchunks = (n + grain - 1) / grain;
+
+			std::atomic<std::size_t> pending{ nchunks - 1 };
+			std::atomic<bool> failed{ false };
+			std::exception_ptr error;								// the first one, read after pending is 0
+
+			auto fail = [&failed, &error](std::exception_ptr e) {
+				if (!failed.exchange(true, std::memory_order_relaxed))
+					error = std::move(e);
+			};
+			auto run = [&body, &failed, &fail](std::size_t bi, std::size_t ei) {
+				if (failed.load(std::memory_order_relaxed))
+					return;
+				try
+				{
+					body(bi, ei);
+				}
+				catch (...)
+				{
+					fail(std::current_exception());
+				}
+			};
+
+			std::size_t c = 1;
+			try
+			{
+				for (; c < nchunks; ++c)
+				{
+					const std::size_t bi = first + c * grain;
+					const std::size_t ei = (std::min)(bi + grain, last);
+					post([&run, &pending, bi, ei] {
+						// counts the chunk down however it ends, the caller's frame lives until then
+						struct Done {
+							std::atomic<std::size_t>& pending;
+							~Done() { pending.fetch_sub(1, std::memory_order_release); }
+						} done{ pending };
+						run(bi, ei);
+					});
+				}
+			}
+			catch (...)
+			{
+				// post could not allocate, the chunks left will never run
+				fail(std::current_exception());
+				pending.fetch_sub(nchunks - c, std::memory_order_release);
+			}
+
+			run(first, (std::min)(first + grain, last));
+			help_while([&pending] { return pending.load(std::memory_order_acquire) != 0; });
+
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+	private:
+
+		struct Worker;
+
+		void WorkerLoop(unsigned index);
+		Task* FindTask(unsigned self);
+		void Run(Task* task);
+		void WakeOne();
+
+		std::vector<std::unique_ptr<Worker>> m_workers;
+		MpmcRingBuffer<Task*> m_injected;							// tasks posted from outside the pool
+
+		// idle workers park on m_epoch (a futex word), posters bump it and wake one if anyone sleeps
+		alignas(cache_line_size) std::atomic<std::uint32_t> m_epoch{ 0 };
+		std::atomic<unsigned> m_sleepers{ 0 };
+		std::atomic<bool> m_stop{ false };
+	};
+}
+
+#endif
@@ -0,0 +1,169 @@
+#include "pch.h"
+#include "Tokenizer.h"
+
+#include <cstring>
+
+#ifdef MODERNCPP_X86
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace MODERNCPP
+{
+	namespace
+	{
+		const std::size_t block_size = 64;
+
+		inline unsigned TrailingZeros(std::uint64_t x)
+		{
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+			unsigned long index;
+			_BitScanForward64(&index, x);
+			return index;
+#elif defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			if (_BitScanForward(&index, static_cast<unsigned long>(x)))
+				return index;
+			_BitScanForward(&index, static_cast<unsigned long>(x >> 32));
+			return index + 32;
+#else
+			return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+		}
+
+		// ' ' or \t \n \v \f \r, which are 9..13
+		inline bool IsSpace(unsigned char c)
+		{
+			return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+		}
+
+		std::uint64_t ClassifyScalar(const char* block)
+		{
+			std::uint64_t mask = 0;
+			for (std::size_t i = 0; i < block_size; ++i)
+				mask |= std::uint64_t(IsSpace(static_cast<unsigned char>(block[i]))) << i;
+			return mask;
+		}
+
+#ifdef MODERNCPP_X86
+		MODERNCPP_TARGET("sse2")
+		inline std::uint64_t Classify16(const char* p)
+		{
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+			// unsigned shifted <= 4 is min(shifted, 4) == shifted
+			const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+			const __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(control, space)));
+		}
+
+		MODERNCPP_TARGET("sse2")
+		std::uint64_t ClassifySSE2(const char* block)
+		{
+			return Classify16(block) | Classify16(block + 16) << 16 | Classify16(block + 32) << 32 | Classify16(block + 48) << 48;
+		}
+
+		MODERNCPP_TARGET("avx2")
+		inline std::uint64_t Classify32(const char* p)
+		{
+			const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			const __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+			const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+			const __m256i space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+			return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(control, space)));
+		}
+
+		MODERNCPP_TARGET("avx2")
+		std::uint64_t ClassifyAVX2(const char* block)
+		{
+			return Classify32(block) | Classify32(block + 32) << 32;
+		}
+
+#endif
+	}
+
+	WordTokenizer::WordTokenizer(std::string_view text, SimdLevel level)
+		: m_text(text), m_classify(ClassifyScalar), m_open(std::string_view::npos)
+	{
+		// never more than the CPU has
+		if (level > DetectSimd())
+			level = DetectSimd();
+#ifdef MODERNCPP_X86
+		if (level == SimdLevel::AVX2)
+			m_classify = ClassifyAVX2;
+		else if (level == SimdLevel::SSE2)
+			m_classify = ClassifySSE2;
+#endif
+	}
+
+	void WordTokenizer::Load()
+	{
+		std::uint64_t space;
+		if (m_text.size() - m_next >= block_size)
+			space = m_classify(m_text.data() + m_next);
+		else
+		{
+			// the tail, padded with whitespace so the last word ends where the text does
+			char tail[block_size];
+			std::memset(tail, ' ', block_size);
+			std::memcpy(tail, m_text.data() + m_next, m_text.size() - m_next);
+			space = m_classify(tail);
+		}
+
+		const std::uint64_t before = (space << 1) | m_prevSpace;		// bit i: byte i - 1 is whitespace
+		m_starts = ~space & before;
+		m_ends = space & ~before;
+		m_prevSpace = space >> 63;
+		m_block = m_next;
+		m_next += block_size;
+	}
+
+	bool WordTokenizer::next(std::string_view& word)
+	{
+		// starts and ends alternate within a block, so the lowest bit is always the next event
+		for (;;)
+		{
+			if (m_open == std::string_view::npos)
+			{
+				if (m_starts)
+				{
+					m_open = m_block + TrailingZeros(m_starts);
+					m_starts &= m_starts - 1;
+					continue;
+				}
+			}
+			else if (m_ends)
+			{
+				const std::size_t end = m_block + TrailingZeros(m_ends);
+				m_ends &= m_ends - 1;
+				word = std::string_view(m_text.data() + m_open, end - m_open);
+				m_open = std::string_view::npos;
+				return true;
+			}
+
+			if (m_next >= m_text.size())
+			{
+				// a word running up to the last byte of a full block
+				if (m_open != std::string_view::npos)
+				{
+					word = m_text.substr(m_open);
+					m_open = std::string_view::npos;
+					return true;
+				}
+				return false;
+			}
+			Load();
+		}
+	}
+
+	std::size_t WordTokenizer::count()
+	{
+		std::size_t n = 0;
+		std::string_view word;
+		while (next(word))
+			++n;
+		return n;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef __MODERN_CPP_TOKENIZER_H
+#define __MODERN_CPP_TOKENIZER_H
+
+#include "Simd.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Whitespace splitting 64 bytes at a time: the block is classified into a bit mask with
+// SSE2 / AVX2 compares, word starts and ends fall out of shifting that mask.
+// https://arxiv.org/abs/1902.08318	(simdjson, the same bit mask technique for structural characters)
+
+namespace MODERNCPP
+{
+	// Yields the same words as iterating std::regex("(\\S+)"): maximal runs of bytes other than
+	// ' ', \t, \n, \v, \f and \r. The words are views into text, nothing is allocated.
+	class WordTokenizer {
+	public:
+
+		explicit WordTokenizer(std::string_view text, SimdLevel level = DetectSimd());
+
+		// false once the text is exhausted
+		bool next(std::string_view& word);
+
+		// words left, consumes them
+		std::size_t count();
+
+	private:
+
+		using Classify = std::uint64_t(*)(const char* block);		// bit i set = block[i] is whitespace
+
+		void Load();
+
+		std::string_view m_text;
+		Classify m_classify;
+		std::size_t m_block = 0;			// offset of the block the masks describe
+		std::size_t m_next = 0;				// offset of the next block to load
+		std::uint64_t m_starts = 0;
+		std::uint64_t m_ends = 0;
+		std::uint64_t m_prevSpace = 1;		// the byte before the block was whitespace
+		std::size_t m_open;					// offset of the word being scanned, npos if none
+	};
+}
+
+#endif
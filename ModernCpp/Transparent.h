@@ -0,0 +1,109 @@
+#pragma once
+
+#ifndef __MODERN_CPP_TRANSPARENT_H
+#define __MODERN_CPP_TRANSPARENT_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+// Heterogeneous lookup: a comparator or hasher with is_transparent lets find / count / contains take
+// a const char* or string_view as it is, instead of building a std::string key for every lookup.
+// https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2013/n3657.htm	(C++14, ordered containers)
+// https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2018/p0919r3.html	(C++20, unordered containers)
+
+namespace MODERNCPP
+{
+	// every string-like argument is hashed and compared as a string_view
+	struct StringHash {
+		using is_transparent = void;
+		std::size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>()(s); }
+	};
+
+	struct StringEqual {
+		using is_transparent = void;
+		bool operator()(std::string_view a, std::string_view b) const noexcept { return a == b; }
+	};
+
+	struct StringLess {
+		using is_transparent = void;
+		bool operator()(std::string_view a, std::string_view b) const noexcept { return a < b; }
+	};
+
+	template <typename V>
+	using StringMap = std::map<std::string, V, StringLess>;
+	using StringSet = std::set<std::string, StringLess>;
+
+	// std::unordered_map only looks up heterogeneously from C++20 on (see Find below),
+	// FlatHashMap::find does with any standard, its default hasher for std::string is a StringHash
+	template <typename K, typename V, typename Hash, typename Eq, typename Alloc>
+	class FlatHashMap;
+
+	template <typename V>
+	using StringUnorderedMap = std::unordered_map<std::string, V, StringHash, StringEqual>;
+	using StringUnorderedSet = std::unordered_set<std::string, StringHash, StringEqual>;
+
+	namespace TRANSPARENT
+	{
+		template <typename T, typename = void>
+		struct HasTransparentCompare : std::false_type {};
+		template <typename T>
+		struct HasTransparentCompare<T, std::void_t<typename T::key_compare::is_transparent>> : std::true_type {};
+
+		template <typename T, typename = void>
+		struct HasTransparentHash : std::false_type {};
+		template <typename T>
+		struct HasTransparentHash<T, std::void_t<typename T::hasher::is_transparent, typename T::key_equal::is_transparent>> : std::true_type {};
+
+#if defined(__cpp_lib_generic_unordered_lookup)
+		constexpr bool unordered_lookup = true;
+#else
+		constexpr bool unordered_lookup = false;
+#endif
+
+		// the key goes to find() as it is where the container takes it, otherwise it becomes a key_type
+		template <typename Container>
+		struct Heterogeneous : std::bool_constant<HasTransparentCompare<Container>::value
+			|| (HasTransparentHash<Container>::value && unordered_lookup)> {};
+
+		// converts by itself when its hasher is not transparent
+		template <typename K, typename V, typename Hash, typename Eq, typename Alloc>
+		struct Heterogeneous<FlatHashMap<K, V, Hash, Eq, Alloc>> : std::true_type {};
+	}
+
+	// C++20's find / count / contains for any associative container, usable from C++17 on: heterogeneous
+	// where the container supports it, a key_type temporary only where it does not.
+	template <typename Container, typename Key>
+	auto Find(Container& c, const Key& key) -> decltype(c.find(std::declval<typename Container::key_type>()))
+	{
+		using key_type = typename Container::key_type;
+		if constexpr (std::is_same<Key, key_type>::value)
+			return c.find(key);
+		else if constexpr (TRANSPARENT::Heterogeneous<std::remove_const_t<Container>>::value)
+		{
+			// a const char* would be measured by strlen in every comparison, do it once
+			if constexpr (std::is_same<key_type, std::string>::value && std::is_convertible<const Key&, std::string_view>::value)
+				return c.find(std::string_view(key));
+			else
+				return c.find(key);
+		}
+		else
+			return c.find(key_type(key));
+	}
+
+	template <typename Container, typename Key>
+	bool Contains(const Container& c, const Key& key) { return Find(c, key) != c.end(); }
+
+	// unique keys, the containers above
+	template <typename Container, typename Key>
+	std::size_t Count(const Container& c, const Key& key) { return Contains(c, key) ? 1 : 0; }
+}
+
+#endif
@@ -0,0 +1,271 @@
+#pragma once
+
+#ifndef __MODERN_CPP_VARIANT_VECTOR_H
+#define __MODERN_CPP_VARIANT_VECTOR_H
+
+#include <tuple>
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <stdexcept>
+#include <type_traits>
+
+// A sequence of std::variant<Ts...> values stored as one std::vector per alternative (structure of
+// arrays) plus a tag and a slot per element. No element is padded to the largest alternative, and
+// visit_all runs over each alternative's array in turn with the type known at compile time: no
+// dispatch per element, and the loop is open to the vectorizer.
+//
+//   VariantVector<int, double, std::string> v;
+//   v.push_back(1); v.push_back(2.5); v.push_back("three"s);
+//   v.visit_all([&](const auto& x) { Add(x); });				// all ints, then all doubles, then all strings
+//   v.visit_in_order([&](const auto& x) { Print(x); });		// 1 2.5 three, one branch per element
+//
+// Elements are appended and cleared, not erased or changed to another alternative.
+// https://en.wikipedia.org/wiki/AoS_and_SoA
+
+namespace MODERNCPP
+{
+	namespace DETAIL
+	{
+		template <typename T, typename... Ts>
+		struct IndexOf {
+			static_assert(sizeof(T) == 0, "the type is not one of the alternatives");
+		};
+
+		template <typename T, typename... Ts>
+		struct IndexOf<T, T, Ts...> : std::integral_constant<std::size_t, 0> {};
+
+		template <typename T, typename U, typename... Ts>
+		struct IndexOf<T, U, Ts...> : std::integral_constant<std::size_t, 1 + IndexOf<T, Ts...>::value> {};
+
+		template <typename... Ts>
+		struct Distinct : std::true_type {};
+
+		template <typename T, typename... Ts>
+		struct Distinct<T, Ts...> : std::bool_constant<(!std::is_same_v<T, Ts> && ...) && Distinct<Ts...>::value> {};
+	}
+
+	template <typename... Ts>
+	class VariantVector {
+		static_assert(sizeof...(Ts) > 0, "VariantVector needs an alternative");
+		static_assert(DETAIL::Distinct<Ts...>::value, "VariantVector alternatives are told apart by type, they must differ");
+
+	public:
+
+		using variant_type = std::variant<Ts...>;
+		using size_type = std::size_t;
+		using tag_type = std::conditional_t<(sizeof...(Ts) <= 256), std::uint8_t, std::uint16_t>;
+		using slot_type = std::uint32_t;		// position in the alternative's array
+
+		static constexpr std::size_t alternatives = sizeof...(Ts);
+
+		// std::variant's index of T
+		template <typename T>
+		static constexpr std::size_t index_of = DETAIL::IndexOf<T, Ts...>::value;
+
+		template <std::size_t I>
+		using alternative = std::variant_alternative_t<I, variant_type>;
+
+		// the elements of one alternative, open to change but not to push_back or clear, which would
+		// leave the tags and slots pointing past them
+		template <typename T>
+		class column_view {
+		public:
+
+			using value_type = T;
+			using iterator = T*;
+
+			T* begin() const noexcept { return m_data; }
+			T* end() const noexcept { return m_data + m_size; }
+			T* data() const noexcept { return m_data; }
+			size_type size() const noexcept { return m_size; }
+			bool empty() const noexcept { return m_size == 0; }
+			T& operator[](size_type i) const noexcept { return m_data[i]; }
+
+		private:
+
+			friend class VariantVector;
+			column_view(T* data, size_type size) noexcept : m_data(data), m_size(size) {}
+
+			T* m_data;
+			size_type m_size;
+		};
+
+		size_type size() const noexcept { return m_tags.size(); }
+		bool empty() const noexcept { return m_tags.empty(); }
+
+		// n elements, the array of T sized for all of them
+		template <typename T>
+		void reserve(size_type n)
+		{
+			std::get<index_of<T>>(m_columns).reserve(n);
+			Reserve(n);
+		}
+
+		void reserve(size_type n) { Reserve(n); }
+
+		void clear() noexcept
+		{
+			std::apply([](auto&... column) { (column.clear(), ...); }, m_columns);
+			m_tags.clear();
+			m_slots.clear();
+		}
+
+		template <typename T, typename... Args>
+		T& emplace_back(Args&&... args)
+		{
+			auto& column = std::get<index_of<T>>(m_columns);
+			if (column.size() == (std::numeric_limits<slot_type>::max)())
+				throw std::length_error("VariantVector: too many elements of one alternative");
+
+			// the element first: if it throws, nothing else has changed
+			column.emplace_back(std::forward<Args>(args)...);
+			try
+			{
+				m_tags.push_back(static_cast<tag_type>(index_of<T>));
+				m_slots.push_back(static_cast<slot_type>(column.size() - 1));
+			}
+			catch (...)
+			{
+				if (m_tags.size() > m_slots.size())
+					m_tags.pop_back();
+				column.pop_back();
+				throw;
+			}
+			return column.back();
+		}
+
+		template <typename T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, variant_type>>>
+		std::decay_t<T>& push_back(T&& value) { return emplace_back<std::decay_t<T>>(std::forward<T>(value)); }
+
+		void push_back(const variant_type& value)
+		{
+			std::visit([this](const auto& x) { emplace_back<std::decay_t<decltype(x)>>(x); }, value);
+		}
+
+		// std::variant::index() of element i
+		std::size_t index(size_type i) const noexcept { return m_tags[i]; }
+
+		template <typename T>
+		bool holds_alternative(size_type i) const noexcept { return m_tags[i] == index_of<T>; }
+
+		// throws std::bad_variant_access if element i is not a T
+		template <typename T>
+		T& get(size_type i)
+		{
+			if (!holds_alternative<T>(i))
+				throw std::bad_variant_access();
+			return std::get<index_of<T>>(m_columns)[m_slots[i]];
+		}
+
+		template <typename T>
+		const T& get(size_type i) const { return const_cast<VariantVector*>(this)->template get<T>(i); }
+
+		template <typename T>
+		T* get_if(size_type i) noexcept { return holds_alternative<T>(i) ? &std::get<index_of<T>>(m_columns)[m_slots[i]] : nullptr; }
+
+		template <typename T>
+		const T* get_if(size_type i) const noexcept { return const_cast<VariantVector*>(this)->template get_if<T>(i); }
+
+		variant_type to_variant(size_type i) const
+		{
+			return visit(i, [](const auto& x) { return variant_type(std::in_place_type<std::decay_t<decltype(x)>>, x); });
+		}
+
+		// the elements that are T, in the order they were added
+		template <typename T>
+		const std::vector<T>& column() const noexcept { return std::get<index_of<T>>(m_columns); }
+
+		template <typename T>
+		column_view<T> column() noexcept
+		{
+			std::vector<T>& c = std::get<index_of<T>>(m_columns);
+			return column_view<T>(c.data(), c.size());
+		}
+
+		// f(element i) as std::visit would call it
+		template <typename F>
+		decltype(auto) visit(size_type i, F&& f) { return Visit(*this, m_tags[i], m_slots[i], f); }
+
+		template <typename F>
+		decltype(auto) visit(size_type i, F&& f) const { return Visit(*this, m_tags[i], m_slots[i], f); }
+
+		// f(x) for every element, alternative by alternative: the order within an alternative is kept,
+		// the order between alternatives is not
+		template <typename F>
+		void visit_all(F&& f)
+		{
+			std::apply([&f](auto&... column) { (RunOf(column, f), ...); }, m_columns);
+		}
+
+		template <typename F>
+		void visit_all(F&& f) const
+		{
+			std::apply([&f](const auto&... column) { (RunOf(column, f), ...); }, m_columns);
+		}
+
+		// f(column) once per alternative, for whole array algorithms
+		template <typename F>
+		void visit_columns(F&& f) const
+		{
+			std::apply([&f](const auto&... column) { (f(column), ...); }, m_columns);
+		}
+
+		// f(x) for every element in the order they were added; an alternative's elements come in the order
+		// of its array, a cursor per alternative stands in for the slots
+		template <typename F>
+		void visit_in_order(F&& f)
+		{
+			slot_type cursors[alternatives] = {};
+			for (const tag_type tag : m_tags)
+				Visit(*this, tag, cursors[tag]++, f);
+		}
+
+		template <typename F>
+		void visit_in_order(F&& f) const
+		{
+			slot_type cursors[alternatives] = {};
+			for (const tag_type tag : m_tags)
+				Visit(*this, tag, cursors[tag]++, f);
+		}
+
+	private:
+
+		void Reserve(size_type n)
+		{
+			m_tags.reserve(n);
+			m_slots.reserve(n);
+		}
+
+		template <typename Column, typename F>
+		static void RunOf(Column& column, F& f)
+		{
+			for (auto& x : column)
+				f(x);
+		}
+
+		// a chain of compares the compiler turns into a jump table or inlines whole, where a table of
+		// function pointers would stop it from inlining f
+		template <std::size_t I = 0, typename Self, typename F>
+		static decltype(auto) Visit(Self& self, std::size_t tag, slot_type slot, F& f)
+		{
+			if constexpr (I + 1 == alternatives)
+				return f(std::get<I>(self.m_columns)[slot]);
+			else
+			{
+				if (tag == I)
+					return f(std::get<I>(self.m_columns)[slot]);
+				return Visit<I + 1>(self, tag, slot, f);
+			}
+		}
+
+		std::tuple<std::vector<Ts>...> m_columns;
+		std::vector<tag_type> m_tags;
+		std::vector<slot_type> m_slots;
+	};
+}
+
+#endif